@@ -0,0 +1,89 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+// minimal benchmark harness: every case is run with a short warm-up and
+// result is printed as one JSON object per line
+class Bench
+{
+
+public:
+
+    Bench(int argc, char** argv)
+        : _scale(1.0),
+          _sink(0)
+    {
+        // usage: <bench> [name filter] [iterations scale]
+        if (argc > 1) {
+            _filter = argv[1];
+        }
+        if (argc > 2) {
+            _scale = std::atof(argv[2]);
+        }
+        if (_scale <= 0.0) {
+            _scale = 1.0;
+        }
+    }
+
+    // keep results of measured code alive (store to volatile member can
+    // not be removed by compiler, so result is not needed by caller)
+    void consume(const int64_t value) noexcept
+    {
+        _sink += value;
+    }
+
+    // run 'fn(i)' for 'iterations' times and print time per operation
+    template <typename Fn>
+    void run(const std::string& name,
+             const std::string& impl,
+             const int64_t      iterations,
+             Fn&&               fn)
+    {
+        if (!_filter.empty() && name.find(_filter) == std::string::npos) {
+            return;
+        }
+
+        const int64_t count = std::max<int64_t>(iterations * _scale, 1);
+
+        for (int64_t i = 0; i < count / 10; ++i) {
+            fn(i);
+        }
+
+        const Clock::time_point start = Clock::now();
+        for (int64_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        const double nanos = std::chrono::duration_cast
+                <std::chrono::nanoseconds>(Clock::now() - start).count();
+
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "{\"case\":\"%s\",\"impl\":\"%s\",\"iterations\":%lld,"
+                      "\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f}",
+                      name.c_str(), impl.c_str(),
+                      static_cast<long long>(count), nanos / count,
+                      nanos ? count * 1e9 / nanos : 0.0);
+        std::cout << line << std::endl;
+    }
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    std::string _filter;
+
+    double _scale;
+
+    volatile int64_t _sink;
+
+};
+
+#endif
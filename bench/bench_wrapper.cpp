@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "../include/column_batch.h"
+#include "../include/connection.h"
+#include "../include/connection_config.h"
+#include "../include/connection_creator.h"
+#include "../include/query_profiler.h"
+#include "../include/row_set.h"
+#include "../include/sqlite3.h"
+#include "../include/statement.h"
+
+
+static const std::string fileName("bench_wrapper.db");
+static const std::string selectById("SELECT id, name FROM Person "
+                                    "WHERE id = ?");
+static const std::string selectAll("SELECT id, name FROM Person");
+static const std::string configScript("PRAGMA foreign_keys = on;");
+static const int rows = 1000;
+static const int groups = 8;
+
+
+// median of group, it is computed by sqlite3 without passing rows out
+struct Median
+{
+    std::vector<int64_t> values;
+
+    void step(int64_t value) {
+        values.push_back(value);
+    }
+
+    int64_t final() {
+        if (values.empty()) {
+            return 0;
+        }
+        std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                         values.end());
+        return values[values.size() / 2];
+    }
+};
+
+
+void createDatabase() {
+    std::remove(fileName.c_str());
+
+    Connection conn(fileName);
+    conn.open();
+    conn.execute("CREATE TABLE Person (id INTEGER NOT NULL PRIMARY KEY, "
+                 "name TEXT NOT NULL)");
+
+    // fill table with rows of short text
+    conn.transaction();
+    Statement insert = conn.prepare("INSERT INTO Person (id, name) "
+                                    "VALUES (?, ?)");
+    for (int i = 0; i < rows; ++i) {
+        insert.execute(i, "person name");
+    }
+    conn.commit();
+}
+
+void benchOpenClose(Bench& bench) {
+    bench.run("open_close", "wrapper", 2000, [&] (int64_t) {
+        Connection conn(fileName);
+        bench.consume(conn.open());
+    });
+
+    bench.run("open_close", "raw", 2000, [&] (int64_t) {
+        sqlite3* db;
+        bench.consume(sqlite3_open_v2(fileName.c_str(), &db,
+                                      SQLITE_OPEN_READWRITE
+                                      | SQLITE_OPEN_CREATE, NULL));
+        sqlite3_close(db);
+    });
+}
+
+void benchNewConnection(Bench& bench) {
+    ConnectionConfig config;
+    config.setDatabaseName(fileName);
+    config.setConfigConnectionScript(configScript);
+
+    ConnectionCreator creator;
+    creator.addConfig(config, "default");
+
+    bench.run("new_connection", "wrapper", 2000, [&] (int64_t) {
+        Connection conn = creator.newConnection("default");
+        bench.consume(conn.isOpen());
+    });
+
+    bench.run("new_connection", "raw", 2000, [&] (int64_t) {
+        sqlite3* db;
+        bench.consume(sqlite3_open_v2(fileName.c_str(), &db,
+                                      SQLITE_OPEN_READWRITE
+                                      | SQLITE_OPEN_CREATE, NULL));
+        sqlite3_exec(db, configScript.c_str(), NULL, NULL, NULL);
+        sqlite3_close(db);
+    });
+}
+
+void benchPrepare(Bench& bench, Connection& conn, sqlite3* db) {
+    bench.run("prepare", "wrapper", 100000, [&] (int64_t) {
+        Statement s = conn.prepare(selectById);
+        bench.consume(s.isValid());
+    });
+
+    conn.setStatementCacheCapacity(16);
+    bench.run("prepare", "wrapper_cached", 100000, [&] (int64_t) {
+        CachedStatement s = conn.prepareCached(selectById);
+        bench.consume(s.isValid());
+    });
+    conn.setStatementCacheCapacity(0);
+
+    bench.run("prepare", "raw", 100000, [&] (int64_t) {
+        sqlite3_stmt* s;
+        bench.consume(sqlite3_prepare_v2(db, selectById.c_str(),
+                                         selectById.size(), &s, NULL));
+        sqlite3_finalize(s);
+    });
+}
+
+void benchBindStep(Bench& bench, Connection& conn, sqlite3* db) {
+    Statement stmt = conn.prepare(selectById);
+    bench.run("bind_step_reset", "wrapper", 500000, [&] (int64_t i) {
+        stmt.bindInt(1, i % rows);
+        stmt.next();
+        bench.consume(stmt.getInt64(0));
+        stmt.rewind();
+    });
+
+    bench.run("bind_step_reset", "wrapper_variadic", 500000, [&] (int64_t i) {
+        stmt.bindAll(i % rows);
+        stmt.next();
+        bench.consume(stmt.get<int64_t>(0));
+        stmt.rewind();
+    });
+
+    sqlite3_stmt* raw;
+    sqlite3_prepare_v2(db, selectById.c_str(), -1, &raw, NULL);
+    bench.run("bind_step_reset", "raw", 500000, [&] (int64_t i) {
+        sqlite3_bind_int(raw, 1, i % rows);
+        sqlite3_step(raw);
+        bench.consume(sqlite3_column_int64(raw, 0));
+        sqlite3_reset(raw);
+    });
+    sqlite3_finalize(raw);
+}
+
+void benchGetText(Bench& bench, Connection& conn, sqlite3* db) {
+    Statement stmt = conn.prepare(selectAll);
+    bench.run("get_text", "wrapper_string", 200, [&] (int64_t) {
+        while (stmt.next()) {
+            bench.consume(stmt.getString(1).size());
+        }
+        stmt.rewind();
+    });
+
+    bench.run("get_text", "wrapper_cstr", 200, [&] (int64_t) {
+        while (stmt.next()) {
+            bench.consume(stmt.getCStr(1).second);
+        }
+        stmt.rewind();
+    });
+
+    sqlite3_stmt* raw;
+    sqlite3_prepare_v2(db, selectAll.c_str(), -1, &raw, NULL);
+    bench.run("get_text", "raw", 200, [&] (int64_t) {
+        while (sqlite3_step(raw) == SQLITE_ROW) {
+            sqlite3_column_text(raw, 1);
+            bench.consume(sqlite3_column_bytes(raw, 1));
+        }
+        sqlite3_reset(raw);
+    });
+    sqlite3_finalize(raw);
+}
+
+void benchRows(Bench& bench, Connection& conn, sqlite3* db) {
+    Statement stmt = conn.prepare(selectAll);
+    bench.run("rows", "wrapper_rows", 200, [&] (int64_t) {
+        for (const std::tuple<int64_t, std::string>& row
+             : stmt.rows<int64_t, std::string>()) {
+            bench.consume(std::get<0>(row) + std::get<1>(row).size());
+        }
+        stmt.rewind();
+    });
+
+    bench.run("rows", "wrapper_loop", 200, [&] (int64_t) {
+        while (stmt.next()) {
+            bench.consume(stmt.getInt64(0) + stmt.getString(1).size());
+        }
+        stmt.rewind();
+    });
+
+    sqlite3_stmt* raw;
+    sqlite3_prepare_v2(db, selectAll.c_str(), -1, &raw, NULL);
+    bench.run("rows", "raw", 200, [&] (int64_t) {
+        while (sqlite3_step(raw) == SQLITE_ROW) {
+            const std::string name(reinterpret_cast<const char*>
+                                   (sqlite3_column_text(raw, 1)),
+                                   sqlite3_column_bytes(raw, 1));
+            bench.consume(sqlite3_column_int64(raw, 0) + name.size());
+        }
+        sqlite3_reset(raw);
+    });
+    sqlite3_finalize(raw);
+}
+
+void benchFetchBatch(Bench& bench, Connection& conn) {
+    Statement stmt = conn.prepare(selectAll);
+    bench.run("fetch_batch", "row_loop", 200, [&] (int64_t) {
+        int64_t sum = 0;
+        while (stmt.next()) {
+            sum += stmt.getInt64(0) + stmt.getCStr(1).second;
+        }
+        bench.consume(sum);
+        stmt.rewind();
+    });
+
+    ColumnBatch batch;
+    bench.run("fetch_batch", "batch_256", 200, [&] (int64_t) {
+        int64_t sum = 0;
+        while (stmt.fetchBatch(batch, 256)) {
+            const int64_t* ids = batch.integers(0);
+            const uint32_t* offsets = batch.offsets(1);
+            for (int i = 0; i < batch.rowCount(); ++i) {
+                sum += ids[i];
+            }
+            sum += offsets[batch.rowCount()];
+        }
+        bench.consume(sum);
+        stmt.rewind();
+    });
+}
+
+void benchRowSet(Bench& bench, Connection& conn) {
+    Statement stmt = conn.prepare(selectAll);
+    bench.run("materialize", "strings", 200, [&] (int64_t) {
+        std::vector<std::pair<int64_t, std::string>> result;
+        while (stmt.next()) {
+            result.emplace_back(stmt.getInt64(0), stmt.getString(1));
+        }
+        bench.consume(result.size());
+        stmt.rewind();
+    });
+
+    RowSet rows;
+    bench.run("materialize", "row_set", 200, [&] (int64_t) {
+        rows.clear();
+        bench.consume(rows.append(stmt));
+        stmt.rewind();
+    });
+}
+
+void benchProfiler(Bench& bench, Connection& conn) {
+    Statement stmt = conn.prepare(selectById);
+    bench.run("profiler", "disabled", 500000, [&] (int64_t i) {
+        stmt.bindInt(1, i % rows);
+        stmt.next();
+        bench.consume(stmt.getInt64(0));
+        stmt.rewind();
+    });
+
+    conn.setProfiler(std::make_shared<QueryProfiler>());
+    bench.run("profiler", "enabled", 500000, [&] (int64_t i) {
+        stmt.bindInt(1, i % rows);
+        stmt.next();
+        bench.consume(stmt.getInt64(0));
+        stmt.rewind();
+    });
+    conn.setProfiler(nullptr);
+}
+
+void benchAggregate(Bench& bench, Connection& conn) {
+    conn.createAggregate<Median>("median");
+
+    Statement ids = conn.prepare("SELECT id FROM Person");
+    bench.run("median", "fetch_rows", 200, [&] (int64_t) {
+        Median median;
+        while (ids.next()) {
+            median.step(ids.getInt64(0));
+        }
+        bench.consume(median.final());
+        ids.rewind();
+    });
+
+    Statement total = conn.prepare("SELECT median(id) FROM Person");
+    bench.run("median", "aggregate", 200, [&] (int64_t) {
+        total.next();
+        bench.consume(total.getInt64(0));
+        total.rewind();
+    });
+
+    // every row is passed to application and grouped there
+    Statement all = conn.prepare("SELECT id % 8, id FROM Person");
+    bench.run("group_median", "fetch_rows", 200, [&] (int64_t) {
+        std::vector<int64_t> values[groups];
+        while (all.next()) {
+            values[all.getInt(0)].push_back(all.getInt64(1));
+        }
+        for (std::vector<int64_t>& group : values) {
+            std::nth_element(group.begin(), group.begin() + group.size() / 2,
+                             group.end());
+            bench.consume(group[group.size() / 2]);
+        }
+        all.rewind();
+    });
+
+    // only one row per group is passed to application (groups are sorted
+    // by sqlite3, so it is not free)
+    Statement grouped = conn.prepare("SELECT median(id) FROM Person "
+                                     "GROUP BY id % 8");
+    bench.run("group_median", "aggregate", 200, [&] (int64_t) {
+        while (grouped.next()) {
+            bench.consume(grouped.getInt64(0));
+        }
+        grouped.rewind();
+    });
+}
+
+void benchReadInt64(Bench& bench, Connection& conn, sqlite3* db) {
+    static const std::string query("SELECT id FROM Person WHERE id = 1");
+
+    bench.run("read_int64", "wrapper", 100000, [&] (int64_t) {
+        bench.consume(conn.readInt64(query));
+    });
+
+    conn.setStatementCacheCapacity(16);
+    bench.run("read_int64", "wrapper_cached", 100000, [&] (int64_t) {
+        bench.consume(conn.readInt64(query));
+    });
+    conn.setStatementCacheCapacity(0);
+
+    bench.run("read_int64", "raw", 100000, [&] (int64_t) {
+        sqlite3_stmt* s;
+        sqlite3_prepare_v2(db, query.c_str(), query.size(), &s, NULL);
+        if (sqlite3_step(s) == SQLITE_ROW) {
+            bench.consume(sqlite3_column_int64(s, 0));
+        }
+        sqlite3_finalize(s);
+    });
+}
+
+int main(int argc, char** argv) {
+    Bench bench(argc, argv);
+
+    createDatabase();
+
+    benchOpenClose(bench);
+    benchNewConnection(bench);
+
+    {
+        Connection conn(fileName);
+        conn.open();
+
+        sqlite3* db;
+        sqlite3_open_v2(fileName.c_str(), &db, SQLITE_OPEN_READWRITE, NULL);
+
+        benchPrepare(bench, conn, db);
+        benchBindStep(bench, conn, db);
+        benchGetText(bench, conn, db);
+        benchRows(bench, conn, db);
+        benchFetchBatch(bench, conn);
+        benchRowSet(bench, conn);
+        benchAggregate(bench, conn);
+        benchReadInt64(bench, conn, db);
+        benchProfiler(bench, conn);
+
+        sqlite3_close(db);
+    }
+
+    std::remove(fileName.c_str());
+
+    return 0;
+}
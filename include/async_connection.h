@@ -0,0 +1,220 @@
+#ifndef ASYNC_CONNECTION_H
+#define ASYNC_CONNECTION_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "connection.h"
+#include "statement_cache.h"
+
+
+// values are kept in queued work until it is executed, so C-strings are
+// copied to std::string (data of other pointer-based values must outlive
+// the work)
+template <typename T>
+struct AsyncValue
+{
+    using type = typename std::decay<T>::type;
+};
+
+template <>
+struct AsyncValue<const char*>
+{
+    using type = std::string;
+};
+
+template <>
+struct AsyncValue<char*>
+{
+    using type = std::string;
+};
+
+template <std::size_t N>
+struct AsyncValue<char[N]>
+{
+    using type = std::string;
+};
+
+
+class AsyncConnection
+{
+
+public:
+
+    static constexpr int defaultMaxQueueSize { 1024 };
+
+    explicit AsyncConnection(Connection&& connection,
+                             const int    maxQueueSize = defaultMaxQueueSize);
+
+    AsyncConnection(const AsyncConnection&) = delete;
+
+    ~AsyncConnection() noexcept;
+
+    std::future<bool> execute(const std::string& query);
+
+    template <typename... Args>
+    std::future<bool> execute(const std::string& query,
+                              const Args&...     args);
+
+    bool isRunning() const noexcept;
+
+    int maxQueueSize() const noexcept;
+
+    int queueSize() const noexcept;
+
+    template <typename T, typename... Args>
+    std::future<std::pair<T, int>> read(const std::string& query,
+                                        const Args&...     args);
+
+    void stop() noexcept;
+
+    template <typename Fn>
+    std::future<typename std::result_of<Fn(Connection&)>::type>
+    submit(Fn&& work);
+
+    template <typename Fn>
+    std::future<typename std::result_of<Fn(Connection&)>::type>
+    trySubmit(Fn&& work);
+
+    AsyncConnection& operator=(const AsyncConnection&) = delete;
+
+private:
+
+    using Task = std::function<void (Connection&)>;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+
+    std::deque<Task> _queue;
+
+    const int _maxQueueSize;
+
+    bool _stopping;
+
+    Connection _connection;
+
+    std::thread _worker;
+
+    bool push(Task&& task,
+              const bool wait);
+
+    void run() noexcept;
+
+    template <typename Fn>
+    std::future<typename std::result_of<Fn(Connection&)>::type>
+    enqueue(Fn&& work, const bool wait);
+
+    template <typename Tuple, std::size_t... Is>
+    static bool executeValues(const Statement&     statement,
+                              const Tuple&         values,
+                              IndexSequence<Is...>) noexcept;
+
+    template <typename T, typename Tuple, std::size_t... Is>
+    static T readValues(Connection&          connection,
+                        const std::string&   query,
+                        int&                 resultCode,
+                        const Tuple&         values,
+                        IndexSequence<Is...>);
+
+};
+
+
+template <typename... Args>
+std::future<bool> AsyncConnection::execute(const std::string& query,
+                                           const Args&...     args)
+{
+    using Values = std::tuple<typename AsyncValue<Args>::type...>;
+    using Indexes = typename MakeIndexSequence<sizeof...(Args)>::type;
+
+    const Values values(args...);
+
+    // prepare (or take cached) statement, bind values and execute it
+    return submit([query, values] (Connection& connection) -> bool {
+        CachedStatement stmt = connection.prepareCached(query);
+        return stmt.isValid() && executeValues(*stmt, values, Indexes());
+    });
+}
+
+template <typename T, typename... Args>
+std::future<std::pair<T, int>>
+AsyncConnection::read(const std::string& query,
+                      const Args&...     args)
+{
+    using Values = std::tuple<typename AsyncValue<Args>::type...>;
+    using Indexes = typename MakeIndexSequence<sizeof...(Args)>::type;
+
+    const Values values(args...);
+
+    // read value and result code
+    return submit([query, values] (Connection& connection)
+                  -> std::pair<T, int> {
+        int code;
+        T value = readValues<T>(connection, query, code, values, Indexes());
+        return std::pair<T, int>(std::move(value), code);
+    });
+}
+
+template <typename Fn>
+std::future<typename std::result_of<Fn(Connection&)>::type>
+AsyncConnection::submit(Fn&& work)
+{
+    return enqueue(std::forward<Fn>(work), true);
+}
+
+template <typename Fn>
+std::future<typename std::result_of<Fn(Connection&)>::type>
+AsyncConnection::trySubmit(Fn&& work)
+{
+    return enqueue(std::forward<Fn>(work), false);
+}
+
+template <typename Fn>
+std::future<typename std::result_of<Fn(Connection&)>::type>
+AsyncConnection::enqueue(Fn&& work, const bool wait)
+{
+    using Result = typename std::result_of<Fn(Connection&)>::type;
+    using PackagedTask = std::packaged_task<Result (Connection&)>;
+
+    // wrap work to copyable task (result is passed through the future)
+    std::shared_ptr<PackagedTask> task
+            = std::make_shared<PackagedTask>(std::forward<Fn>(work));
+    std::future<Result> result = task->get_future();
+
+    // return invalid future, if work is not accepted
+    if (!push([task] (Connection& connection) { (*task)(connection); },
+              wait)) {
+        return std::future<Result>();
+    }
+
+    return result;
+}
+
+template <typename Tuple, std::size_t... Is>
+bool AsyncConnection::executeValues(const Statement&     statement,
+                                    const Tuple&         values,
+                                    IndexSequence<Is...>) noexcept
+{
+    return statement.execute(std::get<Is>(values)...);
+}
+
+template <typename T, typename Tuple, std::size_t... Is>
+T AsyncConnection::readValues(Connection&          connection,
+                              const std::string&   query,
+                              int&                 resultCode,
+                              const Tuple&         values,
+                              IndexSequence<Is...>)
+{
+    return connection.read<T>(query, &resultCode, std::get<Is>(values)...);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef BACKUP_H
+#define BACKUP_H
+
+#include <chrono>
+#include <functional>
+
+struct sqlite3_backup;
+
+
+// online copy of database to another connection by small steps: source is
+// locked only within a step, so writers wait for one step at most (copying
+// is restarted by sqlite3, if source is changed by another connection);
+// after 'maxRestarts' restarts 'run' copies the rest by one step, so then
+// writers of source wait for the whole copy (backup of shared-cache
+// destination, that is locked by its readers, fails and must be started
+// again); locked database is waited for by 'maxBusyRetries' retries in a
+// row at most, then 'run' fails with SQLITE_BUSY or SQLITE_LOCKED
+class Backup
+{
+
+public:
+
+    // arguments are remaining and total pages, false cancels backup
+    using ProgressHandler = std::function<bool (int, int)>;
+
+    static constexpr int defaultPagesPerStep { 64 };
+    static constexpr int defaultMaxRestarts { 8 };
+    static constexpr int defaultMaxBusyRetries { 64 };
+
+    Backup() noexcept;
+
+    Backup(const Backup&) = delete;
+
+    Backup(Backup&& backup) noexcept;
+
+    ~Backup() noexcept;
+
+    bool finish() noexcept;
+
+    bool isOpen() const noexcept;
+
+    int lastResultCode() const noexcept;
+
+    int pageCount() const noexcept;
+
+    int remaining() const noexcept;
+
+    int restarts() const noexcept;
+
+    // negative 'pagesPerStep' copies the whole database by one step
+    bool run(const int                       pagesPerStep
+                 = defaultPagesPerStep,
+             const std::chrono::milliseconds pause
+                 = std::chrono::milliseconds(0),
+             const int                       maxRestarts
+                 = defaultMaxRestarts,
+             const int                       maxBusyRetries
+                 = defaultMaxBusyRetries);
+
+    void setProgressHandler(const ProgressHandler& handler);
+
+    int step(const int pages = defaultPagesPerStep) noexcept;
+
+    Backup& operator=(const Backup&) = delete;
+
+    Backup& operator=(Backup&& backup) noexcept;
+
+private:
+
+    friend class Connection;
+
+    // waiting of locked database, when step returns SQLITE_BUSY or
+    // SQLITE_LOCKED
+    static constexpr std::chrono::milliseconds minBusyDelay { 1 };
+    static constexpr std::chrono::milliseconds maxBusyDelay { 64 };
+
+    sqlite3_backup* _backup;
+
+    ProgressHandler _progress;
+
+    int _lastResultCode;
+    int _remaining;
+    int _restarts;
+
+    Backup(sqlite3_backup* const backup,
+           const int             resultCode) noexcept;
+
+};
+
+#endif
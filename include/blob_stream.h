@@ -0,0 +1,80 @@
+#ifndef BLOB_STREAM_H
+#define BLOB_STREAM_H
+
+#include <cstdint>
+
+struct sqlite3_blob;
+
+
+// incremental reading and writing of blob by chunks (size of blob can not
+// be changed, so space for writing is reserved with ZeroBlob)
+class BlobStream
+{
+
+public:
+
+    BlobStream() noexcept;
+
+    BlobStream(const BlobStream&) = delete;
+
+    BlobStream(BlobStream&& stream) noexcept;
+
+    ~BlobStream() noexcept;
+
+    bool close() noexcept;
+
+    bool isOpen() const noexcept;
+
+    bool isWritable() const noexcept;
+
+    int lastResultCode() const noexcept;
+
+    int position() const noexcept;
+
+    int read(void* const buffer,
+             const int   bytes) noexcept;
+
+    bool readAt(void* const buffer,
+                const int   bytes,
+                const int   offset) noexcept;
+
+    bool reopen(const int64_t rowId) noexcept;
+
+    int64_t rowId() const noexcept;
+
+    bool seek(const int offset) noexcept;
+
+    int size() const noexcept;
+
+    int write(const void* const data,
+              const int         bytes) noexcept;
+
+    bool writeAt(const void* const data,
+                 const int         bytes,
+                 const int         offset) noexcept;
+
+    BlobStream& operator=(const BlobStream&) = delete;
+
+    BlobStream& operator=(BlobStream&& stream) noexcept;
+
+private:
+
+    friend class Connection;
+
+    sqlite3_blob* _blob;
+
+    int64_t _rowId;
+
+    int _size;
+    int _position;
+    int _lastResultCode;
+
+    bool _writable;
+
+    BlobStream(sqlite3_blob* const blob,
+               const int64_t       rowId,
+               const bool          writable) noexcept;
+
+};
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef BULK_INSERTER_H
+#define BULK_INSERTER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "connection.h"
+#include "statement.h"
+
+
+class BulkInserter
+{
+
+public:
+
+    static constexpr int defaultCommitRows { 100000 };
+    static constexpr int defaultMaxRowsPerStatement { 256 };
+
+    BulkInserter(Connection&                     connection,
+                 const std::string&              table,
+                 const std::vector<std::string>& columns);
+
+    BulkInserter(const BulkInserter&) = delete;
+
+    ~BulkInserter() noexcept;
+
+    template <typename... Args>
+    bool add(const Args&... values);
+
+    std::chrono::milliseconds commitInterval() const noexcept;
+
+    int commitRows() const noexcept;
+
+    std::chrono::microseconds elapsed() const noexcept;
+
+    bool finish();
+
+    bool flush();
+
+    std::string lastError() const;
+
+    int maxRowsPerStatement() const noexcept;
+
+    bool rebuildIndexes() const noexcept;
+
+    uint64_t rowCount() const noexcept;
+
+    double rowsPerSecond() const noexcept;
+
+    void setCommitInterval(const std::chrono::milliseconds value) noexcept;
+
+    void setCommitRows(const int value) noexcept;
+
+    void setMaxRowsPerStatement(const int value) noexcept;
+
+    void setRebuildIndexes(const bool value) noexcept;
+
+    BulkInserter& operator=(const BulkInserter&) = delete;
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class ValueType : uint8_t {
+        Null = 0,
+        Integer,
+        Float,
+        Text,
+        Blob
+    };
+
+    struct Value {
+        ValueType   type;
+        int64_t     integer;
+        double      real;
+        std::string bytes;
+    };
+
+    Connection& _connection;
+
+    const std::string _table;
+    const std::vector<std::string> _columns;
+
+    std::vector<Value> _values;
+    std::vector<std::pair<std::string, std::string>> _droppedIndexes;
+
+    Statement _statement;
+
+    std::string _lastError;
+
+    std::chrono::milliseconds _commitInterval;
+    int _commitRows;
+    int _maxRowsPerStatement;
+    bool _rebuildIndexes;
+
+    int _rowsPerStatement;
+    int _bufferedRows;
+    int _rowsInTransaction;
+    bool _ownTransaction;
+    bool _started;
+    bool _failed;
+
+    uint64_t _rowCount;
+
+    Clock::time_point _startTime;
+    Clock::time_point _transactionTime;
+    Clock::time_point _finishTime;
+
+    bool bindRows(const Statement& statement,
+                  const int        rows) noexcept;
+
+    std::string buildQuery(const int rows) const;
+
+    bool commitIfNeeded();
+
+    bool dropIndexes();
+
+    bool fail(const std::string& message,
+              const bool         withDbError = true);
+
+    bool insertRows(const int rows);
+
+    bool restoreIndexes();
+
+    bool rowAdded();
+
+    bool start();
+
+    Value& valueAt(const int column) noexcept;
+
+    void storeValues(const int) noexcept;
+
+    template <typename T, typename... Args>
+    void storeValues(const int      column,
+                     const T&       value,
+                     const Args&... values);
+
+    static void store(Value& target, std::nullptr_t) noexcept;
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value>::type
+    store(Value& target, const T value) noexcept;
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    store(Value& target, const T value) noexcept;
+
+    static void store(Value& target, const char* const value);
+
+    static void store(Value& target, const std::string& value);
+
+    static void store(Value&                             target,
+                      const std::pair<const char*, int>& value);
+
+    static void store(Value&                                      target,
+                      const std::pair<const unsigned char*, int>& value);
+
+    static void store(Value&                            target,
+                      const std::vector<unsigned char>& value);
+
+    template <typename T>
+    static void store(Value& target, const std::pair<T, bool>& value);
+
+    static std::string quoted(const std::string& identifier);
+
+};
+
+
+template <typename... Args>
+bool BulkInserter::add(const Args&... values)
+{
+    // open transaction and prepare statement on the first row
+    if (_failed || (!_started && !start())) {
+        return false;
+    }
+
+    // other count of values would be written out of the row (or values of
+    // the previous row would be inserted)
+    if (sizeof...(Args) != _columns.size()) {
+        return fail("Error adding row: " + std::to_string(sizeof...(Args))
+                    + " values for " + std::to_string(_columns.size())
+                    + " columns", false);
+    }
+
+    // copy values to the buffer and insert rows, if buffer is full
+    storeValues(0, values...);
+    return rowAdded();
+}
+
+inline void BulkInserter::storeValues(const int) noexcept
+{}
+
+template <typename T, typename... Args>
+void BulkInserter::storeValues(const int      column,
+                               const T&       value,
+                               const Args&... values)
+{
+    store(valueAt(column), value);
+    storeValues(column + 1, values...);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+BulkInserter::store(Value& target, const T value) noexcept
+{
+    target.type = ValueType::Integer;
+    target.integer = static_cast<int64_t>(value);
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+BulkInserter::store(Value& target, const T value) noexcept
+{
+    target.type = ValueType::Float;
+    target.real = value;
+}
+
+template <typename T>
+void BulkInserter::store(Value& target, const std::pair<T, bool>& value)
+{
+    if (value.second) {
+        store(target, value.first);
+    } else {
+        store(target, nullptr);
+    }
+}
+
+#endif
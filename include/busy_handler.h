@@ -0,0 +1,102 @@
+#ifndef BUSY_HANDLER_H
+#define BUSY_HANDLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+struct sqlite3;
+
+
+// waits for locks of other connections: SQLITE_BUSY is retried by timeout
+// of sqlite3 or by exponential backoff with jitter, SQLITE_LOCKED of
+// shared-cache connections is retried after sqlite3_unlock_notify callback
+class BusyHandler
+{
+
+public:
+
+    enum class Strategy : uint8_t {
+        None = 0,
+        Timeout,
+        Backoff
+    };
+
+    struct Stats {
+        uint64_t busyEvents;
+        uint64_t retries;
+        uint64_t timeouts;
+        uint64_t waitNanos;
+        uint64_t unlockWaits;
+        uint64_t unlockWaitNanos;
+    };
+
+    static constexpr std::chrono::milliseconds defaultTimeout { 5000 };
+    static constexpr std::chrono::microseconds defaultInitialDelay { 100 };
+    static constexpr std::chrono::microseconds defaultMaxDelay { 50000 };
+
+    explicit BusyHandler(const Strategy                  strategy
+                             = Strategy::Backoff,
+                         const std::chrono::milliseconds timeout
+                             = defaultTimeout) noexcept;
+
+    BusyHandler(const BusyHandler&) = delete;
+
+    ~BusyHandler() noexcept = default;
+
+    bool attach(sqlite3* const db) noexcept;
+
+    std::chrono::microseconds initialDelay() const noexcept;
+
+    std::chrono::microseconds maxDelay() const noexcept;
+
+    void resetStats() noexcept;
+
+    void setDelays(const std::chrono::microseconds initial,
+                   const std::chrono::microseconds max) noexcept;
+
+    void setUnlockNotify(const bool enabled) noexcept;
+
+    Stats stats() const noexcept;
+
+    Strategy strategy() const noexcept;
+
+    std::chrono::milliseconds timeout() const noexcept;
+
+    bool unlockNotify() const noexcept;
+
+    BusyHandler& operator=(const BusyHandler&) = delete;
+
+    static void detach(sqlite3* const db) noexcept;
+
+    static bool waitForUnlock(sqlite3* const db) noexcept;
+
+private:
+
+    std::atomic<uint64_t> _busyEvents;
+    std::atomic<uint64_t> _retries;
+    std::atomic<uint64_t> _timeouts;
+    std::atomic<uint64_t> _waitNanos;
+    std::atomic<uint64_t> _unlockWaits;
+    std::atomic<uint64_t> _unlockWaitNanos;
+
+    std::chrono::milliseconds _timeout;
+    std::chrono::microseconds _initialDelay;
+    std::chrono::microseconds _maxDelay;
+
+    Strategy _strategy;
+
+    std::atomic_bool _unlockNotify;
+
+    // handlers of connections, that wait for unlock notification
+    static std::mutex _mutex;
+    static std::unordered_map<sqlite3*, BusyHandler*> _handlers;
+
+    static int backoff(void*     context,
+                       const int count);
+
+};
+
+#endif
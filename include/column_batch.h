@@ -0,0 +1,111 @@
+#ifndef COLUMN_BATCH_H
+#define COLUMN_BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct sqlite3_stmt;
+
+
+// column-major buffers of rows fetched by Statement::fetchBatch(): numbers
+// are kept in contiguous arrays, text and blobs in one data buffer with
+// offsets, nulls are marked in bitmaps (bit is set for null value)
+//
+// type of column is found by every fetch: it is taken from the first row
+// (declared type is used for null value) and is promoted, when value of
+// the next row does not fit it: integer column becomes float for float
+// value, numeric column becomes text (or blob) for text (or blob) value
+// and text column becomes blob for blob value (values of the previous rows
+// are converted as SQLite converts them), value of text or blob column is
+// taken as text, value of float column is taken as double
+class ColumnBatch
+{
+
+public:
+
+    enum class Type : uint8_t {
+        Integer = 0,
+        Float,
+        Text,
+        Blob
+    };
+
+    ColumnBatch() noexcept;
+
+    ColumnBatch(const ColumnBatch& batch) = default;
+
+    ColumnBatch(ColumnBatch&& batch) noexcept = default;
+
+    ~ColumnBatch() noexcept = default;
+
+    std::pair<const unsigned char*, int> blob(const int column,
+                                              const int row) const noexcept;
+
+    void clear() noexcept;
+
+    int columnCount() const noexcept;
+
+    const char* data(const int column) const noexcept;
+
+    const double* floats(const int column) const noexcept;
+
+    const int64_t* integers(const int column) const noexcept;
+
+    bool isNull(const int column,
+                const int row) const noexcept;
+
+    const uint64_t* nullBitmap(const int column) const noexcept;
+
+    const uint32_t* offsets(const int column) const noexcept;
+
+    void reset() noexcept;
+
+    int rowCount() const noexcept;
+
+    std::pair<const char*, int> text(const int column,
+                                     const int row) const noexcept;
+
+    Type type(const int column) const noexcept;
+
+    ColumnBatch& operator=(const ColumnBatch& batch) = default;
+
+    ColumnBatch& operator=(ColumnBatch&& batch) noexcept = default;
+
+private:
+
+    friend class Statement;
+
+    struct Column {
+        Type                  type;
+        std::vector<int64_t>  integers;
+        std::vector<double>   floats;
+        std::vector<uint32_t> offsets;
+        std::string           data;
+        std::vector<uint64_t> nulls;
+    };
+
+    std::vector<Column> _columns;
+
+    int _rowCount;
+    int _maxRows;
+
+    bool _typed;
+
+    void appendRow(sqlite3_stmt* const statement);
+
+    void prepare(sqlite3_stmt* const statement,
+                 const int           maxRows);
+
+    void promote(Column&    column,
+                 const Type type);
+
+    void reserve(Column& column);
+
+    static Type typeOf(sqlite3_stmt* const statement,
+                       const int           column) noexcept;
+
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef COLUMN_VIEW_H
+#define COLUMN_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "value_traits.h"
+
+
+// view of column value without copying, it is valid until the statement
+// steps to another row, is reset, moved or destroyed (checked in debug mode
+// only by row generation, that is shared with the statement, so view is
+// plain pointer and size in release mode and library and its users have
+// to be built with the same DEBUG setting)
+template <typename T>
+class ColumnView
+{
+
+public:
+
+    using value_type = T;
+    using const_iterator = const T*;
+
+#ifdef DEBUG
+    ColumnView() noexcept
+        : _data(nullptr),
+          _size(0),
+          _generation(0)
+    {}
+
+    ColumnView(const T* const                         data,
+               const size_t                           size,
+               const std::shared_ptr<const uint64_t>& rowGeneration) noexcept
+        : _data(data),
+          _size(size),
+          _rowGeneration(rowGeneration),
+          _generation(rowGeneration ? *rowGeneration : 0)
+    {}
+#else
+    ColumnView() noexcept
+        : _data(nullptr),
+          _size(0)
+    {}
+
+    ColumnView(const T* const data,
+               const size_t   size) noexcept
+        : _data(data),
+          _size(size)
+    {}
+#endif
+
+    const T* begin() const noexcept
+    {
+        return data();
+    }
+
+    const T* data() const noexcept
+    {
+        check();
+        return _data;
+    }
+
+    bool empty() const noexcept
+    {
+        return !_size;
+    }
+
+    const T* end() const noexcept
+    {
+        return data() + _size;
+    }
+
+    bool isNull() const noexcept
+    {
+        return !_data;
+    }
+
+    bool isValid() const noexcept;
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    std::basic_string<T> toString() const
+    {
+        return _size ? std::basic_string<T>(data(), _size)
+                     : std::basic_string<T>();
+    }
+
+    std::vector<T> toVector() const
+    {
+        return std::vector<T>(begin(), end());
+    }
+
+    const T& operator[](const size_t index) const noexcept
+    {
+        WRAPPER_ASSERT(index < _size);
+        return data()[index];
+    }
+
+private:
+
+    const T* _data;
+    size_t _size;
+
+#ifdef DEBUG
+    std::shared_ptr<const uint64_t> _rowGeneration;
+    uint64_t _generation;
+#endif
+
+    void check() const noexcept
+    {
+        WRAPPER_ASSERT(isValid());
+    }
+
+};
+
+using TextView = ColumnView<char>;
+using Text16View = ColumnView<char16_t>;
+using BlobView = ColumnView<unsigned char>;
+
+
+template <typename T>
+bool ColumnView<T>::isValid() const noexcept
+{
+    // view of default value is always valid (and any view in release mode)
+#ifdef DEBUG
+    return !_rowGeneration || *_rowGeneration == _generation;
+#else
+    return true;
+#endif
+}
+
+template <typename T>
+bool operator==(const ColumnView<T>&        left,
+                const std::basic_string<T>& right) noexcept
+{
+    return left.size() == right.size()
+            && std::char_traits<T>::compare(left.begin(), right.data(),
+                                            right.size()) == 0;
+}
+
+template <typename T>
+bool operator==(const std::basic_string<T>& left,
+                const ColumnView<T>&        right) noexcept
+{
+    return right == left;
+}
+
+template <typename T>
+bool operator!=(const ColumnView<T>&        left,
+                const std::basic_string<T>& right) noexcept
+{
+    return !(left == right);
+}
+
+template <typename T>
+bool operator!=(const std::basic_string<T>& left,
+                const ColumnView<T>&        right) noexcept
+{
+    return !(right == left);
+}
+
+#endif
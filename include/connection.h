@@ -2,14 +2,23 @@
 #define SQLITE_CONN_H
 
 #include <atomic>
-#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 
+#include "backup.h"
+#include "blob_stream.h"
+#include "busy_handler.h"
+#include "query_profiler.h"
+#include "sql_function.h"
 #include "statement.h"
+#include "statement_cache.h"
 
 struct sqlite3;
+struct sqlite3_context;
+struct sqlite3_mem_methods;
 struct sqlite3_stmt;
+struct sqlite3_value;
 
 class Connection
 {
@@ -27,6 +36,11 @@ public:
         NullValue = -3
     };
 
+    enum class Allocator : uint8_t {
+        Default = 0,
+        ThreadCaching
+    };
+
     enum class CacheMode : uint8_t {
         Private = 0,
         Shared
@@ -62,20 +76,44 @@ public:
 
     Connection(const Connection&) = delete;
 
-    Connection(Connection&& connection) noexcept = default;
+    Connection(Connection&& connection) noexcept;
 
     virtual ~Connection();
 
+    Backup backupTo(Connection&        destination,
+                    const std::string& destinationName = "main",
+                    const std::string& sourceName = "main");
+
+    std::shared_ptr<BusyHandler> busyHandler() const noexcept;
+
     void close() noexcept;
 
     bool commit() noexcept;
 
+    // arguments are deduced from 'State::step', result from 'State::final'
+    template <typename State>
+    bool createAggregate(const std::string& name,
+                         const bool         deterministic = false,
+                         const bool         directOnly = false);
+
+    // argument and result types are deduced from 'function', deterministic
+    // function can be used in indexes and is evaluated once for constants,
+    // direct-only function is not called by views, triggers and schema
+    // (sqlite3 3.30 or newer is needed, older versions ignore it)
+    template <typename Fn>
+    bool createFunction(const std::string& name,
+                        Fn&&               function,
+                        const bool         deterministic = false,
+                        const bool         directOnly = false);
+
     bool execute(const char* const query) noexcept;
 
     bool execute(const std::string& query) noexcept;
 
     std::string databaseName() const noexcept;
 
+    bool inTransaction() const noexcept;
+
     bool isOpen() const noexcept;
 
     std::string lastError() const;
@@ -84,13 +122,30 @@ public:
 
     int lastResultCode() const noexcept;
 
+    int limit(const int id) const noexcept;
+
     bool open();
 
+    BlobStream openBlob(const std::string& table,
+                        const std::string& column,
+                        const int64_t      rowId,
+                        const bool         writable = false,
+                        const std::string& database = "main");
+
+    template <typename T, typename... Args>
+    T read(const std::string& query,
+           int*               resultCode,
+           const Args&...     args);
+
     Statement prepare(const char* const query,
                       const int         length = -1) noexcept;
 
     Statement prepare(const std::string& query) noexcept;
 
+    CachedStatement prepareCached(const std::string& query);
+
+    std::shared_ptr<QueryProfiler> profiler() const noexcept;
+
     double readDouble(const std::string& query,
                       int*               resultCode = nullptr) noexcept;
 
@@ -103,10 +158,27 @@ public:
     std::u16string readString16(const std::string& query,
                                 int*               resultCode = nullptr);
 
+    void resetStatementCacheStats() noexcept;
+
     bool rollback() noexcept;
 
+    void setBusyHandler(const std::shared_ptr<BusyHandler>& handler) noexcept;
+
+    bool setBusyTimeout(const int milliseconds) noexcept;
+
     void setDbName(const std::string& dbPath);
 
+    bool setLookaside(const int slotSize,
+                      const int slotCount) noexcept;
+
+    void setProfiler(const std::shared_ptr<QueryProfiler>& profiler) noexcept;
+
+    void setStatementCacheCapacity(const int capacity) noexcept;
+
+    int statementCacheCapacity() const noexcept;
+
+    StatementCache::Stats statementCacheStats() const noexcept;
+
     bool transaction() noexcept;
 
     Connection& operator=(const Connection&) = delete;
@@ -119,6 +191,22 @@ public:
 
     static int openedConnNumber() noexcept;
 
+    static int setAllocator(const Allocator value);
+
+    static int setDefaultLookaside(const int slotSize,
+                                   const int slotCount);
+
+    static int setMemoryStatus(const bool enabled);
+
+    static int setPageCache(const int pageSize,
+                            const int pageCount);
+
+    static Allocator allocator() noexcept;
+
+    static int64_t memoryUsed() noexcept;
+
+    static int64_t memoryHighwater(const bool reset = false) noexcept;
+
 private:
 
     sqlite3* _db;
@@ -130,10 +218,19 @@ private:
     CacheMode  _cacheMode;
 
     int _lastResultCode;
+    int _stmtCacheCapacity;
+
+    std::shared_ptr<StatementCache> _stmtCache;
+    std::shared_ptr<QueryProfiler> _profiler;
+    std::shared_ptr<BusyHandler> _busyHandler;
 
     static std::mutex _mutex;
     static std::atomic_uint _openedConn;
+    static std::atomic_uint _openingConn;
     static std::atomic<ThreadMode> _libThreadMode;
+    static std::atomic<Allocator> _libAllocator;
+    static std::unique_ptr<char[]> _pageCache;
+    static std::unique_ptr<sqlite3_mem_methods> _defaultMemMethods;
 
     int getOpenFlags() const noexcept;
 
@@ -143,13 +240,107 @@ private:
 
     int openTemporaryDb();
 
-    int readValue(const std::string&                  query,
-                  std::function<void (sqlite3_stmt*)> readLambda);
+    bool registerFunction(const std::string& name,
+                          const int          arity,
+                          const bool         deterministic,
+                          const bool         directOnly,
+                          void* const        function,
+                          void (*call)(sqlite3_context*, int, sqlite3_value**),
+                          void (*step)(sqlite3_context*, int, sqlite3_value**),
+                          void (*finalize)(sqlite3_context*),
+                          void (*destroy)(void*)) noexcept;
+
+    template <typename T, typename... Args>
+    int readValue(T&                 value,
+                  const std::string& query,
+                  const Args&...     args);
 
     static int configOptionFor(const ThreadMode value) noexcept;
 
     static int tryConfigThreadMode(const int option) noexcept;
 
+    template <typename... Args>
+    static int tryConfig(const int     option,
+                         const Args... args) noexcept;
+
 };
 
+
+template <typename State>
+bool Connection::createAggregate(const std::string& name,
+                                 const bool         deterministic,
+                                 const bool         directOnly)
+{
+    using Aggregate = AggregateFunction<State>;
+
+    // state is kept by sqlite3 for each group, so no object is passed
+    return registerFunction(name, Aggregate::arity, deterministic, directOnly,
+                            nullptr, nullptr, &Aggregate::step,
+                            &Aggregate::finalize, nullptr);
+}
+
+template <typename Fn>
+bool Connection::createFunction(const std::string& name,
+                                Fn&&               function,
+                                const bool         deterministic,
+                                const bool         directOnly)
+{
+    using Function = ScalarFunction<typename std::decay<Fn>::type>;
+
+    // function object is owned by sqlite3 from here (it is freed by 'destroy')
+    Function* const object = new Function(std::forward<Fn>(function));
+
+    return registerFunction(name, Function::arity, deterministic, directOnly,
+                            object, &Function::call, nullptr, nullptr,
+                            &Function::destroy);
+}
+
+template <typename T, typename... Args>
+T Connection::read(const std::string& query,
+                   int*               resultCode,
+                   const Args&...     args)
+{
+    T result = T();
+
+    // try read value
+    const int code = readValue(result, query, args...);
+
+    // save result code, if pointer is valid
+    if (resultCode) {
+        *resultCode = code;
+    }
+
+    // return result
+    return result;
+}
+
+template <typename T, typename... Args>
+int Connection::readValue(T&                 value,
+                          const std::string& query,
+                          const Args&...     args)
+{
+    // try take prepared statement from the cache
+    CachedStatement stmt = prepareCached(query);
+    if (!stmt.isValid()) {
+        return _lastResultCode;
+    }
+
+    // bind parameters (values are used before this function returns)
+    if (!stmt->bindAll(args...)) {
+        return _lastResultCode = stmt->lastErrorCode();
+    }
+
+    // read data (or set the error code)
+    if (!stmt->columnCount()) {
+        return NoData;
+    } else if (!stmt->next()) {
+        return EmptyData;
+    } else if (stmt->isNull(0)) {
+        return NullValue;
+    }
+
+    value = stmt->get<T>(0);
+    return ReadSuccess;
+}
+
 #endif
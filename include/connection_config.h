@@ -1,7 +1,11 @@
 #ifndef CONNECTION_CONFIG_H
 #define CONNECTION_CONFIG_H
 
+#include <cstdint>
+#include <limits>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "connection.h"
 
@@ -11,6 +15,40 @@ class ConnectionConfig
 
 public:
 
+    enum class JournalMode : uint8_t {
+        NotSet = 0,
+        Delete,
+        Truncate,
+        Persist,
+        Memory,
+        Wal,
+        Off
+    };
+
+    enum class Preset : uint8_t {
+        Durable = 0,
+        FastIngest,
+        ReadMostly
+    };
+
+    enum class Synchronous : uint8_t {
+        NotSet = 0,
+        Off,
+        Normal,
+        Full,
+        Extra
+    };
+
+    enum class TempStore : uint8_t {
+        NotSet = 0,
+        Default,
+        File,
+        Memory
+    };
+
+    // value of numeric setting, which is not changed at open
+    static constexpr int64_t notSet { std::numeric_limits<int64_t>::min() };
+
     ConnectionConfig();
 
     ConnectionConfig(const ConnectionConfig& config) = default;
@@ -19,6 +57,19 @@ public:
 
     ~ConnectionConfig() noexcept = default;
 
+    bool addMigration(const int          version,
+                      const std::string& script);
+
+    bool applyPreset(const std::string& name);
+
+    void applyPreset(const Preset value);
+
+    int64_t busyTimeout() const noexcept;
+
+    int64_t cacheSize() const noexcept;
+
+    void clearMigrations() noexcept;
+
     std::string databaseName() const;
 
     Connection::CacheMode cacheMode() const noexcept;
@@ -29,8 +80,28 @@ public:
 
     bool equal(const ConnectionConfig& config) const noexcept;
 
+    JournalMode journalMode() const noexcept;
+
+    int64_t lookasideSlotCount() const noexcept;
+
+    int64_t lookasideSlotSize() const noexcept;
+
+    const std::map<int, std::string>& migrations() const noexcept;
+
+    int64_t mmapSize() const noexcept;
+
     Connection::OpenMode openMode() const noexcept;
 
+    int64_t pageSize() const noexcept;
+
+    void resetTuning();
+
+    int schemaVersion() const noexcept;
+
+    bool setBusyTimeout(const int64_t milliseconds);
+
+    bool setCacheSize(const int64_t value);
+
     void setDatabaseName(const std::string& databaseName);
 
     void setCacheMode(const Connection::CacheMode value) noexcept;
@@ -39,8 +110,33 @@ public:
 
     void setCreateSchemaScript(const std::string& script);
 
+    void setJournalMode(const JournalMode value);
+
+    bool setLookaside(const int64_t slotSize,
+                      const int64_t slotCount);
+
+    bool setMmapSize(const int64_t bytes);
+
     void setOpenMode(const Connection::OpenMode value) noexcept;
 
+    bool setPageSize(const int64_t bytes);
+
+    void setSynchronous(const Synchronous value);
+
+    void setTempStore(const TempStore value);
+
+    bool setWalAutocheckpoint(const int64_t pages);
+
+    Synchronous synchronous() const noexcept;
+
+    TempStore tempStore() const noexcept;
+
+    bool tune(Connection& connection) const noexcept;
+
+    std::string tuningScript() const;
+
+    int64_t walAutocheckpoint() const noexcept;
+
     ConnectionConfig& operator=(const ConnectionConfig& config) = default;
 
     ConnectionConfig& operator=(ConnectionConfig&& config) noexcept = default;
@@ -51,9 +147,29 @@ private:
     std::string _createSchemaScript;
     std::string _configConnectionScript;
 
+    // pragmas are built from checked values, when settings are changed,
+    // and each of them is prepared by tune
+    std::vector<std::string> _tuningPragmas;
+
+    std::map<int, std::string> _migrations;
+
+    int64_t _busyTimeout;
+    int64_t _cacheSize;
+    int64_t _lookasideSlotCount;
+    int64_t _lookasideSlotSize;
+    int64_t _mmapSize;
+    int64_t _pageSize;
+    int64_t _walAutocheckpoint;
+
     Connection::CacheMode _cacheMode;
     Connection::OpenMode  _openMode;
 
+    JournalMode _journalMode;
+    Synchronous _synchronous;
+    TempStore   _tempStore;
+
+    void updateTuningPragmas();
+
 };
 
 #endif
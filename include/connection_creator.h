@@ -1,6 +1,10 @@
 #ifndef CONNECTION_CREATOR_H
 #define CONNECTION_CREATOR_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -9,6 +13,8 @@
 
 #include "connection.h"
 #include "connection_config.h"
+#include "connection_pool.h"
+#include "wal_connection_group.h"
 
 
 class ConnectionCreator
@@ -16,7 +22,7 @@ class ConnectionCreator
 
 public:
 
-    ConnectionCreator() = default;
+    ConnectionCreator();
 
     ConnectionCreator(const ConnectionCreator& conn);
 
@@ -24,6 +30,8 @@ public:
 
     ~ConnectionCreator() noexcept;
 
+    PooledConnection acquireConnection(const std::string& configName) const;
+
     bool addConfig(const ConnectionConfig& value,
                    const std::string&      name);
 
@@ -37,14 +45,38 @@ public:
     std::pair<ConnectionConfig, bool>
     configByName(const std::string& name) const noexcept;
 
+    std::shared_ptr<const ConnectionConfig>
+    configSnapshot(const std::string& name) const noexcept;
+
     int configsCount() const noexcept;
 
+    bool createPool(const std::string&              configName,
+                    const int                       minSize,
+                    const int                       maxSize,
+                    const std::chrono::milliseconds acquireTimeout
+                        = ConnectionPool::defaultAcquireTimeout);
+
     bool deleteConfig(const std::string& name);
 
+    bool deletePool(const std::string& configName);
+
     bool isConfigExists(const std::string& name) const noexcept;
 
     Connection newConnection(const std::string& configName) const;
 
+    std::shared_ptr<WalConnectionGroup>
+    newWalGroup(const std::string&              configName,
+                const int                       readers,
+                const std::chrono::milliseconds acquireTimeout
+                    = ConnectionPool::defaultAcquireTimeout) const;
+
+    std::pair<ConnectionPool::Stats, bool>
+    poolStats(const std::string& configName) const noexcept;
+
+    std::vector<Connection> prewarm(const std::string& configName,
+                                    const int          count,
+                                    const int          threads = 0) const;
+
     bool replaceConfig(const std::string&      name,
                        const ConnectionConfig& newValue);
 
@@ -54,15 +86,74 @@ public:
 
 private:
 
+    using Configs = std::unordered_map<std::string,
+                                       std::shared_ptr<const ConnectionConfig>>;
+
+    // schema version of database file, its mutex serializes migration of
+    // this file only
+    struct SchemaVersion {
+        std::mutex mutex;
+        int version;
+        bool isMigrated;
+    };
+
+    // schema versions of database files, which were migrated already
+    // (entries are never removed, so references to them stay valid)
+    struct SchemaVersions {
+        std::mutex mutex;
+        std::unordered_map<std::string, SchemaVersion> versions;
+    };
+
+    // snapshot of configs cached by thread, it is used until version of
+    // creator is changed
+    struct CachedConfigs {
+        uint64_t                       version;
+        std::shared_ptr<const Configs> configs;
+    };
+
+    static constexpr size_t maxCachedConfigs { 64 };
+
+    // versions are unique for all creators, so cache of destroyed creator
+    // is never used by new one with the same address
+    static std::atomic<uint64_t> _lastVersion;
+
+    // writers are serialized by mutex, readers check version without lock
+    // and take snapshot under short lock only after it is published
     mutable std::mutex _mutex;
+    mutable std::mutex _snapshotMutex;
+
+    std::atomic<uint64_t> _version;
+    std::shared_ptr<const Configs> _configurations;
+    std::shared_ptr<SchemaVersions> _schemaVersions;
+    std::unordered_map<std::string,
+                       std::shared_ptr<ConnectionPool>> _pools;
+
+    std::shared_ptr<const Configs> configsSnapshot() const noexcept;
+
+    std::shared_ptr<Configs> copyConfigs() const;
+
+    std::shared_ptr<ConnectionPool>
+    poolByName(const std::string& configName) const noexcept;
+
+    void publishConfigs(std::shared_ptr<Configs>&& configs) noexcept;
+
+    static bool configureConnection(Connection&        connection,
+                                    const std::string& script) noexcept;
+
+    static bool createSchema(Connection&        connection,
+                             const std::string& script) noexcept;
+
+    static bool enableWal(Connection& connection);
 
-    std::unordered_map<std::string, ConnectionConfig> _configurations;
+    static bool migrate(Connection&             connection,
+                        const ConnectionConfig& config);
 
-    bool configureConnection(Connection&        connection,
-                             const std::string& script) const noexcept;
+    static bool migrateOnce(Connection&             connection,
+                            const ConnectionConfig& config,
+                            SchemaVersions&         schemaVersions);
 
-    bool createSchema(Connection&        connection,
-                      const std::string& script) const noexcept;
+    static Connection openConnection(const ConnectionConfig& config,
+                                     SchemaVersions&         schemaVersions);
 
 };
 
@@ -0,0 +1,143 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "connection.h"
+
+class ConnectionPool;
+
+
+class PooledConnection
+{
+
+public:
+
+    PooledConnection() noexcept;
+
+    PooledConnection(const PooledConnection&) = delete;
+
+    PooledConnection(PooledConnection&& lease) noexcept;
+
+    ~PooledConnection() noexcept;
+
+    Connection& connection() noexcept;
+
+    bool isValid() const noexcept;
+
+    void release() noexcept;
+
+    PooledConnection& operator=(const PooledConnection&) = delete;
+
+    PooledConnection& operator=(PooledConnection&& lease) noexcept;
+
+    Connection* operator->() noexcept;
+
+    Connection& operator*() noexcept;
+
+private:
+
+    friend class ConnectionPool;
+
+    std::shared_ptr<ConnectionPool> _pool;
+
+    Connection _connection;
+
+    PooledConnection(std::shared_ptr<ConnectionPool>&& pool,
+                     Connection&&                      connection) noexcept;
+
+};
+
+
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>
+{
+
+public:
+
+    using Factory = std::function<Connection ()>;
+
+    struct Stats {
+        uint64_t acquired;
+        uint64_t saturated;
+        uint64_t timeouts;
+        uint64_t totalWaitMicros;
+        uint64_t maxWaitMicros;
+        int      idle;
+        int      inUse;
+        int      peakInUse;
+        int      maxSize;
+    };
+
+    static constexpr std::chrono::milliseconds defaultAcquireTimeout {5000};
+
+    ConnectionPool(const ConnectionPool&) = delete;
+
+    ~ConnectionPool() noexcept = default;
+
+    PooledConnection acquire();
+
+    std::chrono::milliseconds acquireTimeout() const noexcept;
+
+    int idleCount() const noexcept;
+
+    int inUseCount() const noexcept;
+
+    int maxSize() const noexcept;
+
+    int minSize() const noexcept;
+
+    void resetStats() noexcept;
+
+    Stats stats() const noexcept;
+
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    static std::shared_ptr<ConnectionPool>
+    create(Factory&&                       factory,
+           const int                       minSize,
+           const int                       maxSize,
+           const std::chrono::milliseconds acquireTimeout
+               = defaultAcquireTimeout);
+
+private:
+
+    friend class PooledConnection;
+
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _released;
+
+    Factory _factory;
+
+    std::vector<Connection> _idle;
+
+    const int _minSize;
+    const int _maxSize;
+    const std::chrono::milliseconds _acquireTimeout;
+
+    int _inUse;
+    int _opening;
+
+    Stats _stats;
+
+    ConnectionPool(Factory&&                       factory,
+                   const int                       minSize,
+                   const int                       maxSize,
+                   const std::chrono::milliseconds acquireTimeout);
+
+    void fill();
+
+    void giveBack(Connection connection) noexcept;
+
+    void recordAcquire(const Clock::time_point& start) noexcept;
+
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef GROUP_COMMIT_WRITER_H
+#define GROUP_COMMIT_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "async_connection.h"
+#include "connection.h"
+
+
+// writes of many threads are pushed to lock-free queue and executed by one
+// connection: every batch is one transaction (each write has own savepoint,
+// so failed write does not roll back others), futures are completed after
+// the shared commit
+class GroupCommitWriter
+{
+
+public:
+
+    using Write = std::function<bool (Connection&)>;
+
+    struct Stats {
+        uint64_t batches;
+        uint64_t writes;
+        uint64_t failedWrites;
+        uint64_t failedCommits;
+    };
+
+    static constexpr int defaultMaxBatchSize { 256 };
+    static constexpr std::chrono::microseconds defaultMaxDelay { 2000 };
+
+    explicit GroupCommitWriter(Connection&&                    connection,
+                               const int                       maxBatchSize
+                                   = defaultMaxBatchSize,
+                               const std::chrono::microseconds maxDelay
+                                   = defaultMaxDelay);
+
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+
+    ~GroupCommitWriter() noexcept;
+
+    std::future<bool> execute(const std::string& query);
+
+    template <typename... Args>
+    std::future<bool> execute(const std::string& query,
+                              const Args&...     args);
+
+    bool isRunning() const noexcept;
+
+    int maxBatchSize() const noexcept;
+
+    std::chrono::microseconds maxDelay() const noexcept;
+
+    Stats stats() const noexcept;
+
+    void stop() noexcept;
+
+    std::future<bool> submit(Write&& write);
+
+    GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+
+private:
+
+    struct Node {
+        Write              write;
+        std::promise<bool> result;
+        Node*              next;
+    };
+
+    static constexpr int noWakeUp { std::numeric_limits<int>::max() };
+
+    // producers push nodes to the head (stack), worker takes all of them
+    // at once and restores order
+    std::atomic<Node*> _head;
+
+    // count of pushed nodes and count of them, worker waits for (producer
+    // wakes worker up, when the count is reached, instead of every push)
+    std::atomic<int> _queued;
+    std::atomic<int> _wakeUpQueued;
+
+    // count of producers between check of stop and push
+    std::atomic<int> _submitting;
+
+    std::atomic_bool _stopping;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+
+    std::atomic<uint64_t> _batches;
+    std::atomic<uint64_t> _writes;
+    std::atomic<uint64_t> _failedWrites;
+    std::atomic<uint64_t> _failedCommits;
+
+    const int _maxBatchSize;
+    const std::chrono::microseconds _maxDelay;
+
+    Connection _connection;
+
+    // statements of transaction are prepared once by worker
+    Statement _begin;
+    Statement _commit;
+    Statement _rollback;
+    Statement _savepoint;
+    Statement _release;
+    Statement _rollbackTo;
+
+    std::thread _worker;
+
+    void commitBatch(Node* const batch[],
+                     const int   size) noexcept;
+
+    static void complete(Node* const node,
+                         const bool  result) noexcept;
+
+    void push(Node* const node) noexcept;
+
+    void run() noexcept;
+
+    Node* takeAll() noexcept;
+
+    template <typename Tuple, std::size_t... Is>
+    static bool executeValues(const Statement&     statement,
+                              const Tuple&         values,
+                              IndexSequence<Is...>) noexcept;
+
+};
+
+
+template <typename... Args>
+std::future<bool> GroupCommitWriter::execute(const std::string& query,
+                                             const Args&...     args)
+{
+    using Values = std::tuple<typename AsyncValue<Args>::type...>;
+    using Indexes = typename MakeIndexSequence<sizeof...(Args)>::type;
+
+    const Values values(args...);
+
+    // prepare (or take cached) statement, bind values and execute it
+    return submit([query, values] (Connection& connection) -> bool {
+        CachedStatement stmt = connection.prepareCached(query);
+        return stmt.isValid() && executeValues(*stmt, values, Indexes());
+    });
+}
+
+template <typename Tuple, std::size_t... Is>
+bool GroupCommitWriter::executeValues(const Statement&     statement,
+                                      const Tuple&         values,
+                                      IndexSequence<Is...>) noexcept
+{
+    return statement.execute(std::get<Is>(values)...);
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef MEMORY_REPLICA_H
+#define MEMORY_REPLICA_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "backup.h"
+#include "busy_handler.h"
+#include "connection.h"
+
+
+// named shared-cache in-memory database, that is copied from database file
+// by backup API: it lives while the replica keeps its connection, readers
+// open own connections to it by 'connect' (tables are locked for the whole
+// refresh, so these connections wait for unlock notification, refresh waits
+// for active reads of replica up to BusyHandler::defaultTimeout)
+class MemoryReplica
+{
+
+public:
+
+    enum class SyncMode : uint8_t {
+        Refresh = 0,
+        Persist
+    };
+
+    MemoryReplica(const std::string& name,
+                  const std::string& fileName);
+
+    MemoryReplica(const MemoryReplica&) = delete;
+
+    ~MemoryReplica() noexcept;
+
+    Connection connect() const;
+
+    std::string fileName() const;
+
+    bool isLoaded() const noexcept;
+
+    std::string lastError() const;
+
+    bool load();
+
+    std::string name() const;
+
+    bool persist();
+
+    bool refresh();
+
+    bool startSync(const std::chrono::milliseconds interval,
+                   const SyncMode                  mode = SyncMode::Refresh);
+
+    void stopSync() noexcept;
+
+    int syncCount() const noexcept;
+
+    MemoryReplica& operator=(const MemoryReplica&) = delete;
+
+private:
+
+    // waiting of readers, when replica is locked by them at refresh
+    static constexpr std::chrono::milliseconds minLockedDelay { 1 };
+    static constexpr std::chrono::milliseconds maxLockedDelay { 64 };
+
+    const std::string _name;
+    const std::string _fileName;
+
+    // keeps in-memory database alive and is used for copying
+    Connection _keeper;
+
+    std::string _lastError;
+
+    int _syncCount;
+
+    bool _stopping;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _stopped;
+
+    std::thread _worker;
+
+    bool copy(const SyncMode mode);
+
+    void run(const std::chrono::milliseconds interval,
+             const SyncMode                  mode) noexcept;
+
+    bool transfer(Connection&    file,
+                  const SyncMode mode);
+
+};
+
+#endif
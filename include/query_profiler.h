@@ -0,0 +1,101 @@
+#ifndef QUERY_PROFILER_H
+#define QUERY_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+
+
+class QueryProfiler
+{
+
+public:
+
+    struct Stats {
+        std::string fingerprint;
+        uint64_t    calls;
+        uint64_t    totalNanos;
+        uint64_t    p50Nanos;
+        uint64_t    p99Nanos;
+        uint64_t    maxNanos;
+    };
+
+    QueryProfiler() noexcept;
+
+    QueryProfiler(const QueryProfiler&) = delete;
+
+    ~QueryProfiler() noexcept = default;
+
+    bool attach(sqlite3* const db) noexcept;
+
+    void record(const void* const statement,
+                const char* const query,
+                const uint64_t    nanos) noexcept;
+
+    void reset() noexcept;
+
+    std::vector<Stats> snapshot() const;
+
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    static void detach(sqlite3* const db) noexcept;
+
+    static std::string fingerprint(const char* const query);
+
+private:
+
+    // 4 buckets for every power of 2 (error of percentiles is below 25%)
+    static constexpr int bucketCount { 252 };
+
+    struct Entry {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> totalNanos;
+        std::atomic<uint64_t> maxNanos;
+        std::atomic<uint64_t> buckets[bucketCount];
+    };
+
+    // entry found for the statement last time, it is cached by thread
+    // to find it without lock (statement address may be reused, so
+    // query is compared too, and profiler address may be reused, so
+    // profiler is identified by number)
+    struct Shortcut {
+        uint64_t    profilerId;
+        std::string query;
+        Entry*      entry;
+    };
+
+    static constexpr size_t maxShortcuts { 4096 };
+
+    static std::atomic<uint64_t> _nextId;
+
+    const uint64_t _id;
+
+    mutable std::mutex _mutex;
+
+    std::unordered_map<std::string, std::unique_ptr<Entry>> _entries;
+
+    Entry* entryFor(const void* const statement,
+                    const char* const query);
+
+    static int bucketOf(const uint64_t nanos) noexcept;
+
+    static uint64_t bucketLimit(const int bucket) noexcept;
+
+    static uint64_t percentile(const Entry&   entry,
+                               const uint64_t calls,
+                               const double   rank) noexcept;
+
+    static int trace(unsigned  type,
+                     void*     context,
+                     void*     statement,
+                     void*     value);
+
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef ROW_RANGE_H
+#define ROW_RANGE_H
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "statement.h"
+
+
+template <std::size_t... Is>
+struct IndexSequence
+{};
+
+template <std::size_t N, std::size_t... Is>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Is...>
+{};
+
+template <std::size_t... Is>
+struct MakeIndexSequence<0, Is...>
+{
+    using type = IndexSequence<Is...>;
+};
+
+// specialize for user types: 'Columns' lists column types (as std::tuple)
+// and 'make' builds row object from decoded column values
+template <typename Row>
+struct RowMapper;
+
+template <typename... Ts>
+struct RowMapper<std::tuple<Ts...>>
+{
+    using Columns = std::tuple<Ts...>;
+
+    static std::tuple<Ts...> make(Ts&&... values)
+    {
+        return std::tuple<Ts...>(std::move(values)...);
+    }
+};
+
+
+template <typename Row>
+class RowRange
+{
+
+public:
+
+    class iterator
+    {
+
+    public:
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row*;
+        using reference = const Row&;
+
+        iterator() noexcept
+            : _statement(nullptr)
+        {}
+
+        explicit iterator(const Statement* const statement)
+            : _statement(statement)
+        {
+            advance();
+        }
+
+        reference operator*() const noexcept
+        {
+            return _row;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &_row;
+        }
+
+        iterator& operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        bool operator==(const iterator& it) const noexcept
+        {
+            return _statement == it._statement;
+        }
+
+        bool operator!=(const iterator& it) const noexcept
+        {
+            return _statement != it._statement;
+        }
+
+    private:
+
+        using Columns = typename RowMapper<Row>::Columns;
+
+        const Statement* _statement;
+
+        Row _row;
+
+        void advance()
+        {
+            // read next row or become end iterator
+            if (_statement->next()) {
+                _row = decode(static_cast<Columns*>(nullptr),
+                              typename MakeIndexSequence
+                              <std::tuple_size<Columns>::value>::type());
+            } else {
+                _statement = nullptr;
+            }
+        }
+
+        template <typename... Cs, std::size_t... Is>
+        Row decode(std::tuple<Cs...>*,
+                   IndexSequence<Is...>) const
+        {
+            return RowMapper<Row>::make(_statement->get<Cs>(Is)...);
+        }
+
+    };
+
+    explicit RowRange(const Statement& statement) noexcept
+        : _statement(&statement)
+    {
+        WRAPPER_ASSERT(statement.isValid());
+        WRAPPER_ASSERT(statement.columnCount() >= static_cast<int>(
+                           std::tuple_size
+                           <typename RowMapper<Row>::Columns>::value));
+    }
+
+    iterator begin() const
+    {
+        return iterator(_statement);
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator();
+    }
+
+private:
+
+    const Statement* _statement;
+
+};
+
+
+template <typename Row>
+RowRange<Row> Statement::rowsAs() const noexcept
+{
+    return RowRange<Row>(*this);
+}
+
+template <typename... Ts>
+RowRange<std::tuple<Ts...>> Statement::rows() const noexcept
+{
+    return RowRange<std::tuple<Ts...>>(*this);
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef ROW_SET_H
+#define ROW_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Statement;
+
+
+// bump allocator: memory is taken from large blocks and freed all at once
+class ResultArena
+{
+
+public:
+
+    static constexpr size_t defaultBlockSize { 64 * 1024 };
+
+    explicit ResultArena(const size_t blockSize = defaultBlockSize) noexcept;
+
+    ResultArena(const ResultArena&) = delete;
+
+    ResultArena(ResultArena&& arena) noexcept = default;
+
+    ~ResultArena() noexcept = default;
+
+    void* allocate(const size_t bytes,
+                   const size_t alignment = alignof(std::max_align_t));
+
+    size_t blockCount() const noexcept;
+
+    size_t bytesReserved() const noexcept;
+
+    size_t bytesUsed() const noexcept;
+
+    void clear() noexcept;
+
+    ResultArena& operator=(const ResultArena&) = delete;
+
+    ResultArena& operator=(ResultArena&& arena) noexcept = default;
+
+private:
+
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    std::vector<std::unique_ptr<char[]>> _large;
+
+    size_t _blockSize;
+    size_t _largeBytes;
+    size_t _offset;
+    size_t _used;
+
+    static char* aligned(char* const  pointer,
+                         const size_t alignment) noexcept;
+
+};
+
+
+// rows of result copied to the arena (text and blobs) and to one array of
+// compact cells, so rows stay valid after statement steps further
+class RowSet
+{
+
+public:
+
+    explicit RowSet(const size_t blockSize = ResultArena::defaultBlockSize)
+    noexcept;
+
+    RowSet(const RowSet&) = delete;
+
+    RowSet(RowSet&& rows) noexcept = default;
+
+    ~RowSet() noexcept = default;
+
+    int append(const Statement& statement,
+               const int        maxRows = -1);
+
+    void clear() noexcept;
+
+    int columnCount() const noexcept;
+
+    int columnType(const int row,
+                   const int column) const noexcept;
+
+    std::pair<const unsigned char*, int> getBlob(const int row,
+                                                 const int column)
+    const noexcept;
+
+    std::pair<const char*, int> getCStr(const int row,
+                                        const int column) const noexcept;
+
+    double getDouble(const int row,
+                     const int column) const noexcept;
+
+    int64_t getInt64(const int row,
+                     const int column) const noexcept;
+
+    std::string getString(const int row,
+                          const int column) const;
+
+    bool isNull(const int row,
+                const int column) const noexcept;
+
+    size_t memoryUsage() const noexcept;
+
+    int rowCount() const noexcept;
+
+    RowSet& operator=(const RowSet&) = delete;
+
+    RowSet& operator=(RowSet&& rows) noexcept = default;
+
+private:
+
+    struct Cell {
+        union {
+            int64_t     integer;
+            double      real;
+            const char* bytes;
+        };
+        int32_t size;
+        int32_t type;
+    };
+
+    ResultArena _arena;
+
+    std::vector<Cell> _cells;
+
+    int _columnCount;
+    int _rowCount;
+
+    const Cell& cell(const int row,
+                     const int column) const noexcept;
+
+    Cell copyCell(const Statement& statement,
+                  const int        column);
+
+};
+
+#endif
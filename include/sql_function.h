@@ -0,0 +1,215 @@
+#ifndef SQL_FUNCTION_H
+#define SQL_FUNCTION_H
+
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "row_range.h"
+#include "value_traits.h"
+
+
+// argument and return types of function, lambda or other functor (functor
+// with overloaded or template call operator can not be deduced)
+template <typename Fn>
+struct FunctionTraits : FunctionTraits<decltype(&Fn::operator())>
+{};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (Args...)>
+{
+    using Result = typename std::decay<R>::type;
+    using Arguments = std::tuple<typename std::decay<Args>::type...>;
+
+    static constexpr int arity { sizeof...(Args) };
+};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...)> : FunctionTraits<R (Args...)>
+{};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...)> : FunctionTraits<R (Args...)>
+{};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) const> : FunctionTraits<R (Args...)>
+{};
+
+
+// scalar SQL function: arguments are converted by ValueTraits straight from
+// sqlite3_value (text and blobs taken as pointer and size are not copied)
+// and result is passed back to sqlite3, exceptions become SQL errors
+template <typename Fn>
+class ScalarFunction
+{
+
+public:
+
+    using Traits = FunctionTraits<Fn>;
+
+    static constexpr int arity { Traits::arity };
+
+    explicit ScalarFunction(Fn&& function)
+        : _function(std::move(function))
+    {}
+
+    explicit ScalarFunction(const Fn& function)
+        : _function(function)
+    {}
+
+    static void call(sqlite3_context* context,
+                     int,
+                     sqlite3_value**  arguments) noexcept
+    {
+        ScalarFunction* const self = static_cast<ScalarFunction*>
+                (SqliteApi::userData(context));
+
+        try {
+            self->invoke(context, arguments,
+                         static_cast<typename Traits::Arguments*>(nullptr),
+                         typename MakeIndexSequence<arity>::type());
+        } catch (const std::bad_alloc&) {
+            SqliteApi::resultErrorNoMem(context);
+        } catch (const std::exception& e) {
+            SqliteApi::resultError(context, e.what());
+        } catch (...) {
+            SqliteApi::resultError(context, "unknown exception in function");
+        }
+    }
+
+    static void destroy(void* function) noexcept
+    {
+        delete static_cast<ScalarFunction*>(function);
+    }
+
+private:
+
+    Fn _function;
+
+    template <typename... Args, std::size_t... Is>
+    void invoke(sqlite3_context*    context,
+                sqlite3_value**     arguments,
+                std::tuple<Args...>*,
+                IndexSequence<Is...>)
+    {
+        ValueTraits<typename Traits::Result>::result(
+                    context, _function(ValueTraits<Args>::value(
+                                           arguments[Is])...));
+    }
+
+};
+
+
+// aggregate SQL function: 'State' is default constructible object with
+// 'step' member, called for every row of group, and 'final' member, which
+// returns result; state is created in memory of sqlite3_aggregate_context
+// at the first row and destroyed after result is taken (empty group gets
+// result of new state)
+template <typename State>
+class AggregateFunction
+{
+
+public:
+
+    using Traits = FunctionTraits<decltype(&State::step)>;
+
+    static constexpr int arity { Traits::arity };
+
+    static void finalize(sqlite3_context* context) noexcept
+    {
+        // memory is not allocated, if group is empty
+        Slot* const slot = static_cast<Slot*>
+                (SqliteApi::aggregateContext(context, 0));
+
+        try {
+            if (slot && slot->constructed) {
+                result(context, *slot->state());
+            } else {
+                State state;
+                result(context, state);
+            }
+        } catch (const std::bad_alloc&) {
+            SqliteApi::resultErrorNoMem(context);
+        } catch (const std::exception& e) {
+            SqliteApi::resultError(context, e.what());
+        } catch (...) {
+            SqliteApi::resultError(context,
+                                   "unknown exception in aggregate");
+        }
+
+        // it is called after failed step too, so state is always freed
+        if (slot && slot->constructed) {
+            slot->state()->~State();
+            slot->constructed = false;
+        }
+    }
+
+    static void step(sqlite3_context* context,
+                     int,
+                     sqlite3_value**  arguments) noexcept
+    {
+        // memory of context is zeroed by sqlite3 at the first row of group
+        Slot* const slot = static_cast<Slot*>
+                (SqliteApi::aggregateContext(context, sizeof(Slot)));
+        if (!slot) {
+            SqliteApi::resultErrorNoMem(context);
+            return;
+        }
+
+        try {
+            if (!slot->constructed) {
+                new (&slot->storage) State();
+                slot->constructed = true;
+            }
+            invoke(*slot->state(), arguments,
+                   static_cast<typename Traits::Arguments*>(nullptr),
+                   typename MakeIndexSequence<arity>::type());
+        } catch (const std::bad_alloc&) {
+            SqliteApi::resultErrorNoMem(context);
+        } catch (const std::exception& e) {
+            SqliteApi::resultError(context, e.what());
+        } catch (...) {
+            SqliteApi::resultError(context,
+                                   "unknown exception in aggregate");
+        }
+    }
+
+private:
+
+    // memory of sqlite3 is aligned to 8 bytes
+    static_assert(alignof(State) <= 8, "state must be aligned to 8 bytes");
+
+    struct Slot {
+        typename std::aligned_storage<sizeof(State),
+                                      alignof(State)>::type storage;
+        bool constructed;
+
+        State* state() noexcept
+        {
+            return reinterpret_cast<State*>(&storage);
+        }
+    };
+
+    template <typename... Args, std::size_t... Is>
+    static void invoke(State&               state,
+                       sqlite3_value**      arguments,
+                       std::tuple<Args...>*,
+                       IndexSequence<Is...>)
+    {
+        state.step(ValueTraits<Args>::value(arguments[Is])...);
+    }
+
+    static void result(sqlite3_context* context,
+                       State&           state)
+    {
+        ValueTraitsFor<decltype(state.final())>::result(context,
+                                                        state.final());
+    }
+
+};
+
+#endif
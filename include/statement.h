@@ -2,12 +2,23 @@
 #define DB_STATEMENT_H
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 
+#include "column_batch.h"
+#include "value_traits.h"
+
 struct sqlite3_stmt;
 struct sqlite3;
 
+template <typename T>
+class ColumnView;
+
+template <typename Row>
+class RowRange;
+
 
 class Statement
 {
@@ -30,6 +41,17 @@ public:
 
     ~Statement() noexcept;
 
+    template <typename T>
+    bool bind(const int  index,
+              const T&   value,
+              const bool copy = true) const noexcept;
+
+    template <typename... Args>
+    bool bindAll(const Args&... args) const noexcept;
+
+    template <typename... Args>
+    bool bindAllCopy(const Args&... args) const noexcept;
+
     bool bindBlob(const int         index,
                   const void* const value,
                   const int         bytes) const noexcept;
@@ -80,6 +102,9 @@ public:
     bool bindString16Copy(const int            index,
                           const std::u16string& value) const noexcept;
 
+    bool bindZeroBlob(const int index,
+                      const int bytes) const noexcept;
+
     int32_t byteLength(const int index) const noexcept;
 
     int32_t byteLength16(const int index) const noexcept;
@@ -94,13 +119,28 @@ public:
 
     bool execute() const noexcept;
 
+    template <typename... Args>
+    bool execute(const Args&... args) const noexcept;
+
     std::string expandedQuery() const;
 
+    // returns count of fetched rows (0 after the last row) or -1 on error
+    // (its code is returned by lastErrorCode) and for not positive maxRows
+    int fetchBatch(ColumnBatch& batch,
+                   const int    maxRows) const;
+
+    ColumnBatch fetchBatch(const int maxRows) const;
+
+    template <typename T>
+    T get(const int index) const;
+
     std::pair<const unsigned char*, int>
     getBlob(const int index) const noexcept;
 
     std::pair<unsigned char*, int> getBlobCopy(const int index) const;
 
+    ColumnView<unsigned char> getBlobView(const int index) const noexcept;
+
     bool getBool(const int index) const noexcept;
 
     std::pair<const char*, int> getCStr(const int index) const noexcept;
@@ -123,6 +163,10 @@ public:
 
     std::u16string getString16(const int index) const;
 
+    ColumnView<char> getTextView(const int index) const noexcept;
+
+    ColumnView<char16_t> getText16View(const int index) const noexcept;
+
     bool isNull(const int index) const noexcept;
 
     bool isValid() const noexcept;
@@ -139,6 +183,14 @@ public:
 
     std::string query() const;
 
+    void rewind() const noexcept;
+
+    template <typename... Ts>
+    RowRange<std::tuple<Ts...>> rows() const noexcept;
+
+    template <typename Row>
+    RowRange<Row> rowsAs() const noexcept;
+
     Type type() const noexcept;
 
     Statement &operator=(const Statement& statement) noexcept = delete;
@@ -156,6 +208,107 @@ private:
     int _columnCount;
     Type _type;
 
+#ifdef DEBUG
+    // changed on every step, so views of the previous row become invalid
+    // (it is shared with views, so they are checked after statement is
+    // destroyed too, and created by the first view only)
+    mutable std::shared_ptr<uint64_t> _rowGeneration;
+#endif
+
+    // the last row is fetched to batch, so the next batch is empty
+    mutable bool _batchFinished;
+
+    bool bindValues(const int,
+                    const bool) const noexcept;
+
+    void nextRow() const noexcept;
+
+    int step() const noexcept;
+
+    template <typename T>
+    ColumnView<T> view(const T* const data,
+                       const size_t   size) const noexcept;
+
+    template <typename T, typename... Args>
+    bool bindValues(const int      index,
+                    const bool     copy,
+                    const T&       value,
+                    const Args&... args) const noexcept;
+
 };
 
+
+template <typename T>
+bool Statement::bind(const int  index,
+                     const T&   value,
+                     const bool copy) const noexcept
+{
+    WRAPPER_ASSERT(_statement != NULL);
+    WRAPPER_ASSERT(index > 0);
+
+    return ValueTraitsFor<T>::bind(_statement, index, value, copy);
+}
+
+template <typename... Args>
+bool Statement::bindAll(const Args&... args) const noexcept
+{
+    WRAPPER_ASSERT(_statement != NULL);
+    WRAPPER_ASSERT(static_cast<int>(sizeof...(Args))
+                   == SqliteApi::parameterCount(_statement));
+
+    return bindValues(1, false, args...);
+}
+
+template <typename... Args>
+bool Statement::bindAllCopy(const Args&... args) const noexcept
+{
+    WRAPPER_ASSERT(_statement != NULL);
+    WRAPPER_ASSERT(static_cast<int>(sizeof...(Args))
+                   == SqliteApi::parameterCount(_statement));
+
+    return bindValues(1, true, args...);
+}
+
+template <typename... Args>
+bool Statement::execute(const Args&... args) const noexcept
+{
+    // bind values without copying, they are alive until step is finished
+    const bool result = bindAll(args...) && execute();
+
+    // do not keep pointers to the caller's data
+    clearBindings();
+
+    return result;
+}
+
+template <typename T>
+T Statement::get(const int index) const
+{
+    WRAPPER_ASSERT(_statement != NULL);
+    WRAPPER_ASSERT(index >= 0);
+    WRAPPER_ASSERT(index < _columnCount);
+
+    return ValueTraits<T>::column(_statement, index);
+}
+
+inline bool Statement::bindValues(const int,
+                                  const bool) const noexcept
+{
+    // all values are bound
+    return true;
+}
+
+template <typename T, typename... Args>
+bool Statement::bindValues(const int      index,
+                           const bool     copy,
+                           const T&       value,
+                           const Args&... args) const noexcept
+{
+    return ValueTraitsFor<T>::bind(_statement, index, value, copy)
+            && bindValues(index + 1, copy, args...);
+}
+
+#include "column_view.h"
+#include "row_range.h"
+
 #endif
@@ -0,0 +1,132 @@
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "statement.h"
+
+struct sqlite3;
+
+class StatementCache;
+
+
+class CachedStatement
+{
+
+public:
+
+    CachedStatement() noexcept;
+
+    CachedStatement(const CachedStatement&) = delete;
+
+    CachedStatement(CachedStatement&& lease) noexcept;
+
+    ~CachedStatement() noexcept;
+
+    bool isValid() const noexcept;
+
+    void release() noexcept;
+
+    Statement& statement() noexcept;
+
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    CachedStatement& operator=(CachedStatement&& lease) noexcept;
+
+    Statement* operator->() noexcept;
+
+    Statement& operator*() noexcept;
+
+private:
+
+    friend class StatementCache;
+
+    std::weak_ptr<StatementCache> _cache;
+
+    void* _slot;
+
+    Statement _statement;
+
+    CachedStatement(std::weak_ptr<StatementCache>&& cache,
+                    void* const                     slot,
+                    Statement&&                     statement) noexcept;
+
+};
+
+
+class StatementCache : public std::enable_shared_from_this<StatementCache>
+{
+
+public:
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        int      size;
+        int      capacity;
+    };
+
+    StatementCache(sqlite3* const db,
+                   const int      capacity) noexcept;
+
+    StatementCache(const StatementCache&) = delete;
+
+    ~StatementCache() noexcept;
+
+    CachedStatement acquire(const std::string& query,
+                            int&               resultCode);
+
+    int capacity() const noexcept;
+
+    void close() noexcept;
+
+    void resetStats() noexcept;
+
+    void setCapacity(const int value) noexcept;
+
+    int size() const noexcept;
+
+    Stats stats() const noexcept;
+
+    StatementCache& operator=(const StatementCache&) = delete;
+
+private:
+
+    friend class CachedStatement;
+
+    using Lru = std::list<const std::string*>;
+
+    struct Slot {
+        Statement     statement;
+        Lru::iterator position;
+        bool          leased;
+    };
+
+    using Slots = std::unordered_map<std::string, Slot>;
+
+    sqlite3* _db;
+
+    int _capacity;
+
+    Slots _slots;
+    Lru _lru;
+
+    Stats _stats;
+
+    void giveBack(void* const slot,
+                  Statement&& statement) noexcept;
+
+    void trim() noexcept;
+
+    static Statement prepare(sqlite3* const     db,
+                             const std::string& query,
+                             int&               resultCode) noexcept;
+
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef THREAD_CACHING_ALLOCATOR_H
+#define THREAD_CACHING_ALLOCATOR_H
+
+#include <cstddef>
+
+struct sqlite3_mem_methods;
+
+
+// sqlite3 allocator: small blocks are rounded up to a few size classes and
+// freed blocks are kept in lists of the current thread, so most allocations
+// take no lock of the system allocator
+class ThreadCachingAllocator
+{
+
+public:
+
+    static constexpr int    classCount { 8 };
+    static constexpr size_t maxCachedSize { 4096 };
+    static constexpr int    maxCachedBlocks { 128 };
+
+    ThreadCachingAllocator() = delete;
+
+    static const sqlite3_mem_methods* methods() noexcept;
+
+private:
+
+    static int classFor(const size_t bytes) noexcept;
+
+    static void* allocate(int bytes);
+
+    static void release(void* pointer);
+
+    static void* reallocate(void* pointer,
+                            int   bytes);
+
+    static int size(void* pointer);
+
+    static int roundUp(int bytes);
+
+    static int init(void*);
+
+    static void shutdown(void*);
+
+};
+
+#endif
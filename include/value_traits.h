@@ -0,0 +1,631 @@
+#ifndef VALUE_TRAITS_H
+#define VALUE_TRAITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// checks of template code are enabled in debug mode only (as in sources)
+#ifdef DEBUG
+#include <cassert>
+#define WRAPPER_ASSERT(expr) assert(expr)
+#else
+#define WRAPPER_ASSERT(expr) static_cast<void>(0)
+#endif
+
+struct sqlite3_context;
+struct sqlite3_stmt;
+struct sqlite3_value;
+
+
+// thin out-of-line calls of sqlite3 API for templates, so public headers do
+// not include sqlite3.h (bind returns true on SQLITE_OK, copied text and
+// blob is bound as SQLITE_TRANSIENT, otherwise as SQLITE_STATIC; results
+// are always copied)
+class SqliteApi
+{
+
+public:
+
+    static void* aggregateContext(sqlite3_context* const context,
+                                  const int              bytes) noexcept;
+
+    static bool bindBlob(sqlite3_stmt* const stmt,
+                         const int           index,
+                         const void* const   value,
+                         const int           bytes,
+                         const bool          copy) noexcept;
+
+    static bool bindDouble(sqlite3_stmt* const stmt,
+                           const int           index,
+                           const double        value) noexcept;
+
+    static bool bindInt(sqlite3_stmt* const stmt,
+                        const int           index,
+                        const int           value) noexcept;
+
+    static bool bindInt64(sqlite3_stmt* const stmt,
+                          const int           index,
+                          const int64_t       value) noexcept;
+
+    static bool bindNull(sqlite3_stmt* const stmt,
+                         const int           index) noexcept;
+
+    static bool bindText(sqlite3_stmt* const stmt,
+                         const int           index,
+                         const char* const   value,
+                         const int           bytes,
+                         const bool          copy) noexcept;
+
+    static bool bindText16(sqlite3_stmt* const stmt,
+                           const int           index,
+                           const void* const   value,
+                           const int           bytes,
+                           const bool          copy) noexcept;
+
+    static bool bindZeroBlob(sqlite3_stmt* const stmt,
+                             const int           index,
+                             const int           bytes) noexcept;
+
+    static const void* columnBlob(sqlite3_stmt* const stmt,
+                                  const int           index) noexcept;
+
+    static int columnBytes(sqlite3_stmt* const stmt,
+                           const int           index) noexcept;
+
+    static int columnBytes16(sqlite3_stmt* const stmt,
+                             const int           index) noexcept;
+
+    static double columnDouble(sqlite3_stmt* const stmt,
+                               const int           index) noexcept;
+
+    static int columnInt(sqlite3_stmt* const stmt,
+                         const int           index) noexcept;
+
+    static int64_t columnInt64(sqlite3_stmt* const stmt,
+                               const int           index) noexcept;
+
+    static bool columnIsNull(sqlite3_stmt* const stmt,
+                             const int           index) noexcept;
+
+    static const char* columnText(sqlite3_stmt* const stmt,
+                                  const int           index) noexcept;
+
+    static const char16_t* columnText16(sqlite3_stmt* const stmt,
+                                        const int           index) noexcept;
+
+    static int parameterCount(sqlite3_stmt* const stmt) noexcept;
+
+    static void resultBlob(sqlite3_context* const context,
+                           const void* const      value,
+                           const int              bytes) noexcept;
+
+    static void resultDouble(sqlite3_context* const context,
+                             const double           value) noexcept;
+
+    static void resultError(sqlite3_context* const context,
+                            const char* const      message) noexcept;
+
+    static void resultErrorNoMem(sqlite3_context* const context) noexcept;
+
+    static void resultInt(sqlite3_context* const context,
+                          const int              value) noexcept;
+
+    static void resultInt64(sqlite3_context* const context,
+                            const int64_t          value) noexcept;
+
+    static void resultNull(sqlite3_context* const context) noexcept;
+
+    static void resultText(sqlite3_context* const context,
+                           const char* const      value,
+                           const int              bytes) noexcept;
+
+    static void resultText16(sqlite3_context* const context,
+                             const void* const      value,
+                             const int              bytes) noexcept;
+
+    static void resultZeroBlob(sqlite3_context* const context,
+                               const int              bytes) noexcept;
+
+    static void* userData(sqlite3_context* const context) noexcept;
+
+    static const void* valueBlob(sqlite3_value* const value) noexcept;
+
+    static int valueBytes(sqlite3_value* const value) noexcept;
+
+    static int valueBytes16(sqlite3_value* const value) noexcept;
+
+    static double valueDouble(sqlite3_value* const value) noexcept;
+
+    static int valueInt(sqlite3_value* const value) noexcept;
+
+    static int64_t valueInt64(sqlite3_value* const value) noexcept;
+
+    static bool valueIsNull(sqlite3_value* const value) noexcept;
+
+    static const char* valueText(sqlite3_value* const value) noexcept;
+
+    static const char16_t* valueText16(sqlite3_value* const value) noexcept;
+
+};
+
+
+template <typename T, typename Enable = void>
+struct ValueTraits;
+
+template <typename T>
+struct ValueTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                              && (sizeof(T) < sizeof(int)
+                                                  || (sizeof(T) == sizeof(int)
+                                                      && std::is_signed<T>::value))
+                                              >::type>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const T             value,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindInt(stmt, index, value);
+    }
+
+    static T column(sqlite3_stmt* const stmt,
+                    const int           index) noexcept
+    {
+        return static_cast<T>(SqliteApi::columnInt(stmt, index));
+    }
+
+    static T value(sqlite3_value* const argument) noexcept
+    {
+        return static_cast<T>(SqliteApi::valueInt(argument));
+    }
+
+    static void result(sqlite3_context* const context,
+                       const T                value) noexcept
+    {
+        SqliteApi::resultInt(context, value);
+    }
+};
+
+template <typename T>
+struct ValueTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                              && !(sizeof(T) < sizeof(int)
+                                                   || (sizeof(T) == sizeof(int)
+                                                       && std::is_signed<T>::value))
+                                              >::type>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const T             value,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindInt64(stmt, index,
+                                    static_cast<int64_t>(value));
+    }
+
+    static T column(sqlite3_stmt* const stmt,
+                    const int           index) noexcept
+    {
+        return static_cast<T>(SqliteApi::columnInt64(stmt, index));
+    }
+
+    static T value(sqlite3_value* const argument) noexcept
+    {
+        return static_cast<T>(SqliteApi::valueInt64(argument));
+    }
+
+    static void result(sqlite3_context* const context,
+                       const T                value) noexcept
+    {
+        SqliteApi::resultInt64(context, static_cast<int64_t>(value));
+    }
+};
+
+template <>
+struct ValueTraits<bool>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const bool          value,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindInt(stmt, index, value);
+    }
+
+    static bool column(sqlite3_stmt* const stmt,
+                       const int           index) noexcept
+    {
+        return SqliteApi::columnInt(stmt, index) != 0;
+    }
+
+    static bool value(sqlite3_value* const argument) noexcept
+    {
+        return SqliteApi::valueInt(argument) != 0;
+    }
+
+    static void result(sqlite3_context* const context,
+                       const bool             value) noexcept
+    {
+        SqliteApi::resultInt(context, value);
+    }
+};
+
+template <typename T>
+struct ValueTraits<T, typename std::enable_if
+                   <std::is_floating_point<T>::value>::type>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const T             value,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindDouble(stmt, index, value);
+    }
+
+    static T column(sqlite3_stmt* const stmt,
+                    const int           index) noexcept
+    {
+        return static_cast<T>(SqliteApi::columnDouble(stmt, index));
+    }
+
+    static T value(sqlite3_value* const argument) noexcept
+    {
+        return static_cast<T>(SqliteApi::valueDouble(argument));
+    }
+
+    static void result(sqlite3_context* const context,
+                       const T                value) noexcept
+    {
+        SqliteApi::resultDouble(context, value);
+    }
+};
+
+template <>
+struct ValueTraits<const char*>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const char* const   value,
+                     const bool          copy) noexcept
+    {
+        return SqliteApi::bindText(stmt, index, value, -1, copy);
+    }
+
+    // pointer is valid until function returns (it is not copied)
+    static const char* value(sqlite3_value* const argument) noexcept
+    {
+        return SqliteApi::valueText(argument);
+    }
+
+    static void result(sqlite3_context* const context,
+                       const char* const      value) noexcept
+    {
+        SqliteApi::resultText(context, value, -1);
+    }
+};
+
+template <>
+struct ValueTraits<char*> : ValueTraits<const char*>
+{};
+
+template <>
+struct ValueTraits<std::string>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const std::string&  value,
+                     const bool          copy) noexcept
+    {
+        return SqliteApi::bindText(stmt, index, value.c_str(),
+                                   value.length(), copy);
+    }
+
+    static std::string column(sqlite3_stmt* const stmt,
+                              const int           index)
+    {
+        std::string result;
+
+        // try read data
+        const char* const ptr = SqliteApi::columnText(stmt, index);
+        if (ptr) {
+            result.assign(ptr, SqliteApi::columnBytes(stmt, index));
+        }
+
+        return result;
+    }
+
+    static std::string value(sqlite3_value* const argument)
+    {
+        std::string result;
+
+        // try read data
+        const char* const ptr = SqliteApi::valueText(argument);
+        if (ptr) {
+            result.assign(ptr, SqliteApi::valueBytes(argument));
+        }
+
+        return result;
+    }
+
+    static void result(sqlite3_context* const context,
+                       const std::string&     value) noexcept
+    {
+        SqliteApi::resultText(context, value.c_str(), value.length());
+    }
+};
+
+template <>
+struct ValueTraits<std::u16string>
+{
+    static bool bind(sqlite3_stmt* const   stmt,
+                     const int             index,
+                     const std::u16string& value,
+                     const bool            copy) noexcept
+    {
+        return SqliteApi::bindText16(stmt, index, value.c_str(),
+                                     value.length() << 1, copy);
+    }
+
+    static std::u16string column(sqlite3_stmt* const stmt,
+                                 const int           index)
+    {
+        std::u16string result;
+
+        // try read data
+        const char16_t* const ptr = SqliteApi::columnText16(stmt, index);
+        if (ptr) {
+            result.assign(ptr, SqliteApi::columnBytes16(stmt, index) >> 1);
+        }
+
+        return result;
+    }
+
+    static std::u16string value(sqlite3_value* const argument)
+    {
+        std::u16string result;
+
+        // try read data
+        const char16_t* const ptr = SqliteApi::valueText16(argument);
+        if (ptr) {
+            result.assign(ptr, SqliteApi::valueBytes16(argument) >> 1);
+        }
+
+        return result;
+    }
+
+    static void result(sqlite3_context* const context,
+                       const std::u16string&  value) noexcept
+    {
+        SqliteApi::resultText16(context, value.c_str(), value.length() << 1);
+    }
+};
+
+template <>
+struct ValueTraits<std::pair<const char*, int>>
+{
+    static bool bind(sqlite3_stmt* const                stmt,
+                     const int                          index,
+                     const std::pair<const char*, int>& value,
+                     const bool                         copy) noexcept
+    {
+        return SqliteApi::bindText(stmt, index, value.first,
+                                   value.second, copy);
+    }
+
+    static std::pair<const char*, int> column(sqlite3_stmt* const stmt,
+                                              const int           index)
+    noexcept
+    {
+        const char* const ptr = SqliteApi::columnText(stmt, index);
+
+        return std::pair<const char*, int>
+        {ptr, SqliteApi::columnBytes(stmt, index)};
+    }
+
+    // text of argument is not copied (it is valid until function returns)
+    static std::pair<const char*, int> value(sqlite3_value* const argument)
+    noexcept
+    {
+        const char* const ptr = SqliteApi::valueText(argument);
+
+        return std::pair<const char*, int>
+        {ptr, SqliteApi::valueBytes(argument)};
+    }
+
+    static void result(sqlite3_context* const             context,
+                       const std::pair<const char*, int>& value) noexcept
+    {
+        SqliteApi::resultText(context, value.first, value.second);
+    }
+};
+
+template <>
+struct ValueTraits<std::pair<const unsigned char*, int>>
+{
+    static bool bind(sqlite3_stmt* const                         stmt,
+                     const int                                   index,
+                     const std::pair<const unsigned char*, int>& value,
+                     const bool                                  copy)
+    noexcept
+    {
+        return SqliteApi::bindBlob(stmt, index, value.first,
+                                   value.second, copy);
+    }
+
+    static std::pair<const unsigned char*, int>
+    column(sqlite3_stmt* const stmt,
+           const int           index) noexcept
+    {
+        const unsigned char* const ptr = static_cast
+                <const unsigned char*>(SqliteApi::columnBlob(stmt, index));
+
+        return std::pair<const unsigned char*, int>
+        {ptr, SqliteApi::columnBytes(stmt, index)};
+    }
+
+    static std::pair<const unsigned char*, int>
+    value(sqlite3_value* const argument) noexcept
+    {
+        const unsigned char* const ptr = static_cast
+                <const unsigned char*>(SqliteApi::valueBlob(argument));
+
+        return std::pair<const unsigned char*, int>
+        {ptr, SqliteApi::valueBytes(argument)};
+    }
+
+    static void result(sqlite3_context* const                      context,
+                       const std::pair<const unsigned char*, int>& value)
+    noexcept
+    {
+        SqliteApi::resultBlob(context, value.first, value.second);
+    }
+};
+
+template <>
+struct ValueTraits<std::pair<const void*, int>>
+{
+    static bool bind(sqlite3_stmt* const                stmt,
+                     const int                          index,
+                     const std::pair<const void*, int>& value,
+                     const bool                         copy) noexcept
+    {
+        return SqliteApi::bindBlob(stmt, index, value.first,
+                                   value.second, copy);
+    }
+
+    static void result(sqlite3_context* const             context,
+                       const std::pair<const void*, int>& value) noexcept
+    {
+        SqliteApi::resultBlob(context, value.first, value.second);
+    }
+};
+
+template <>
+struct ValueTraits<std::vector<unsigned char>>
+{
+    static bool bind(sqlite3_stmt* const               stmt,
+                     const int                         index,
+                     const std::vector<unsigned char>& value,
+                     const bool                        copy) noexcept
+    {
+        return SqliteApi::bindBlob(stmt, index, value.data(),
+                                   value.size(), copy);
+    }
+
+    static std::vector<unsigned char> column(sqlite3_stmt* const stmt,
+                                             const int           index)
+    {
+        const unsigned char* const ptr = static_cast
+                <const unsigned char*>(SqliteApi::columnBlob(stmt, index));
+
+        return ptr ? std::vector<unsigned char>
+                     (ptr, ptr + SqliteApi::columnBytes(stmt, index))
+                   : std::vector<unsigned char>();
+    }
+
+    static std::vector<unsigned char> value(sqlite3_value* const argument)
+    {
+        const unsigned char* const ptr = static_cast
+                <const unsigned char*>(SqliteApi::valueBlob(argument));
+
+        return ptr ? std::vector<unsigned char>
+                     (ptr, ptr + SqliteApi::valueBytes(argument))
+                   : std::vector<unsigned char>();
+    }
+
+    static void result(sqlite3_context* const            context,
+                       const std::vector<unsigned char>& value) noexcept
+    {
+        SqliteApi::resultBlob(context, value.data(), value.size());
+    }
+};
+
+template <>
+struct ValueTraits<std::nullptr_t>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     std::nullptr_t,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindNull(stmt, index);
+    }
+
+    static void result(sqlite3_context* const context,
+                       std::nullptr_t) noexcept
+    {
+        SqliteApi::resultNull(context);
+    }
+};
+
+// blob of 'bytes' zeros (space is reserved for writing with BlobStream)
+struct ZeroBlob
+{
+    int bytes;
+};
+
+template <>
+struct ValueTraits<ZeroBlob>
+{
+    static bool bind(sqlite3_stmt* const stmt,
+                     const int           index,
+                     const ZeroBlob      value,
+                     const bool) noexcept
+    {
+        return SqliteApi::bindZeroBlob(stmt, index, value.bytes);
+    }
+
+    static void result(sqlite3_context* const context,
+                       const ZeroBlob         value) noexcept
+    {
+        SqliteApi::resultZeroBlob(context, value.bytes);
+    }
+};
+
+// value with flag (false means NULL), as returned by ConnectionCreator
+template <typename T>
+struct ValueTraits<std::pair<T, bool>>
+{
+    static bool bind(sqlite3_stmt* const       stmt,
+                     const int                 index,
+                     const std::pair<T, bool>& value,
+                     const bool                copy) noexcept
+    {
+        return value.second
+                ? ValueTraits<T>::bind(stmt, index, value.first, copy)
+                : SqliteApi::bindNull(stmt, index);
+    }
+
+    static std::pair<T, bool> column(sqlite3_stmt* const stmt,
+                                     const int           index)
+    {
+        return !SqliteApi::columnIsNull(stmt, index)
+                ? std::pair<T, bool> {ValueTraits<T>::column(stmt, index),
+                                      true}
+                : std::pair<T, bool> {T(), false};
+    }
+
+    static std::pair<T, bool> value(sqlite3_value* const argument)
+    {
+        return !SqliteApi::valueIsNull(argument)
+                ? std::pair<T, bool> {ValueTraits<T>::value(argument), true}
+                : std::pair<T, bool> {T(), false};
+    }
+
+    static void result(sqlite3_context* const    context,
+                       const std::pair<T, bool>& value)
+    {
+        if (value.second) {
+            ValueTraits<T>::result(context, value.first);
+        } else {
+            SqliteApi::resultNull(context);
+        }
+    }
+};
+
+template <typename T>
+using ValueTraitsFor = ValueTraits<typename std::decay<T>::type>;
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef WAL_CONNECTION_GROUP_H
+#define WAL_CONNECTION_GROUP_H
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "async_connection.h"
+#include "connection.h"
+#include "connection_pool.h"
+#include "statement_cache.h"
+
+
+// one writer connection (all writes are serialized by its queue) and pool
+// of read-only connections over the same database in WAL mode, so readers
+// never wait for the writer: statements of execute are classified by own
+// read-only connection (not by pooled reader) and writes are passed to the
+// writer, reading statements are refused there (rows are read by read,
+// readRows or by acquired reader)
+class WalConnectionGroup
+{
+
+public:
+
+    WalConnectionGroup(Connection&&                      writer,
+                       Connection&&                      classifier,
+                       std::shared_ptr<ConnectionPool>&& readers,
+                       const int                         maxQueueSize
+                           = AsyncConnection::defaultMaxQueueSize);
+
+    WalConnectionGroup(const WalConnectionGroup&) = delete;
+
+    ~WalConnectionGroup() noexcept;
+
+    PooledConnection acquireReader();
+
+    template <typename... Args>
+    std::future<bool> execute(const std::string& query,
+                              const Args&...     args);
+
+    bool isReadQuery(const std::string& query);
+
+    template <typename T, typename... Args>
+    T read(const std::string& query,
+           int*               resultCode,
+           const Args&...     args);
+
+    // 'fn' is called with statement for every row, it returns false on error
+    template <typename Fn, typename... Args>
+    bool readRows(const std::string& query,
+                  Fn&&               fn,
+                  const Args&...     args);
+
+    ConnectionPool::Stats readerStats() const noexcept;
+
+    void stop() noexcept;
+
+    template <typename Fn>
+    std::future<typename std::result_of<Fn(Connection&)>::type>
+    submitWrite(Fn&& work);
+
+    template <typename... Args>
+    std::future<bool> write(const std::string& query,
+                            const Args&...     args);
+
+    AsyncConnection& writer() noexcept;
+
+    WalConnectionGroup& operator=(const WalConnectionGroup&) = delete;
+
+    static bool isRead(const Statement& statement) noexcept;
+
+private:
+
+    static constexpr size_t maxClassifiedQueries { 1024 };
+
+    std::shared_ptr<ConnectionPool> _readers;
+
+    AsyncConnection _writer;
+
+    // classifier prepares statements only (results are kept by query)
+    std::mutex _classifierMutex;
+    Connection _classifier;
+    std::unordered_map<std::string, bool> _readQueries;
+
+    static bool isFinished(const Statement& statement) noexcept;
+
+};
+
+
+template <typename... Args>
+std::future<bool> WalConnectionGroup::execute(const std::string& query,
+                                              const Args&...     args)
+{
+    // reading statement is refused (its rows would be lost)
+    if (isReadQuery(query)) {
+        return std::future<bool>();
+    }
+
+    // pass other statements (and not prepared ones) to the writer
+    return _writer.execute(query, args...);
+}
+
+template <typename T, typename... Args>
+T WalConnectionGroup::read(const std::string& query,
+                           int*               resultCode,
+                           const Args&...     args)
+{
+    PooledConnection reader = _readers->acquire();
+    return reader->read<T>(query, resultCode, args...);
+}
+
+template <typename Fn, typename... Args>
+bool WalConnectionGroup::readRows(const std::string& query,
+                                  Fn&&               fn,
+                                  const Args&...     args)
+{
+    PooledConnection reader = _readers->acquire();
+    CachedStatement stmt = reader->prepareCached(query);
+    if (!stmt.isValid() || !stmt->bindAll(args...)) {
+        return false;
+    }
+
+    const Statement& statement = *stmt;
+    while (statement.next()) {
+        fn(statement);
+    }
+
+    return isFinished(statement);
+}
+
+template <typename Fn>
+std::future<typename std::result_of<Fn(Connection&)>::type>
+WalConnectionGroup::submitWrite(Fn&& work)
+{
+    return _writer.submit(std::forward<Fn>(work));
+}
+
+template <typename... Args>
+std::future<bool> WalConnectionGroup::write(const std::string& query,
+                                            const Args&...     args)
+{
+    return _writer.execute(query, args...);
+}
+
+#endif
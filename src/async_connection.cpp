@@ -0,0 +1,120 @@
+#include "../include/async_connection.h"
+
+#include <algorithm>
+
+using LockGuard = std::lock_guard<std::mutex>;
+using UniqueLock = std::unique_lock<std::mutex>;
+
+
+constexpr int AsyncConnection::defaultMaxQueueSize;
+
+AsyncConnection::AsyncConnection(Connection&& connection,
+                                 const int    maxQueueSize)
+    : _maxQueueSize(std::max(maxQueueSize, 1)),
+      _stopping(false),
+      _connection(std::move(connection))
+{
+    // start worker thread, that owns the connection from now
+    _worker = std::thread(&AsyncConnection::run, this);
+}
+
+AsyncConnection::~AsyncConnection() noexcept
+{
+    stop();
+}
+
+std::future<bool> AsyncConnection::execute(const std::string& query)
+{
+    // execute query (or queries) within worker thread
+    return submit([query] (Connection& connection) -> bool {
+        return connection.execute(query);
+    });
+}
+
+bool AsyncConnection::isRunning() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return !_stopping;
+}
+
+int AsyncConnection::maxQueueSize() const noexcept
+{
+    return _maxQueueSize;
+}
+
+int AsyncConnection::queueSize() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return _queue.size();
+}
+
+void AsyncConnection::stop() noexcept
+{
+    // stop accepting work and wake up all waiting threads
+    {
+        LockGuard lock(_mutex);
+        _stopping = true;
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+
+    // wait until queued work is done
+    if (_worker.joinable() && _worker.get_id() != std::this_thread::get_id()) {
+        _worker.join();
+    }
+}
+
+bool AsyncConnection::push(Task&& task,
+                           const bool wait)
+{
+    UniqueLock lock(_mutex);
+
+    // wait for free place in the queue (or refuse work, if queue is full)
+    if (wait) {
+        _notFull.wait(lock, [this] () {
+            return _stopping
+                    || static_cast<int>(_queue.size()) < _maxQueueSize;
+        });
+    }
+
+    if (_stopping || static_cast<int>(_queue.size()) >= _maxQueueSize) {
+        return false;
+    }
+
+    _queue.push_back(std::move(task));
+    lock.unlock();
+
+    _notEmpty.notify_one();
+    return true;
+}
+
+void AsyncConnection::run() noexcept
+{
+    while (true) {
+        Task task;
+
+        // take next work (queue is drained before stop)
+        {
+            UniqueLock lock(_mutex);
+            _notEmpty.wait(lock, [this] () {
+                return _stopping || !_queue.empty();
+            });
+
+            if (_queue.empty()) {
+                break;
+            }
+
+            task = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        _notFull.notify_one();
+
+        // do work (errors are passed to the caller through the future)
+        task(_connection);
+    }
+
+    // close connection within the thread, that used it
+    _connection.close();
+}
@@ -0,0 +1,185 @@
+#include "../include/backup.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "../include/sqlite3.h"
+
+
+constexpr int Backup::defaultPagesPerStep;
+constexpr int Backup::defaultMaxRestarts;
+constexpr int Backup::defaultMaxBusyRetries;
+constexpr std::chrono::milliseconds Backup::minBusyDelay;
+constexpr std::chrono::milliseconds Backup::maxBusyDelay;
+
+Backup::Backup() noexcept
+    : _backup(NULL),
+      _lastResultCode(SQLITE_OK),
+      _remaining(-1),
+      _restarts(0)
+{}
+
+Backup::Backup(Backup&& backup) noexcept
+    : _backup(backup._backup),
+      _progress(std::move(backup._progress)),
+      _lastResultCode(backup._lastResultCode),
+      _remaining(backup._remaining),
+      _restarts(backup._restarts)
+{
+    backup._backup = NULL;
+}
+
+Backup::Backup(sqlite3_backup* const backup,
+               const int             resultCode) noexcept
+    : _backup(backup),
+      _lastResultCode(resultCode),
+      _remaining(-1),
+      _restarts(0)
+{}
+
+Backup::~Backup() noexcept
+{
+    finish();
+}
+
+bool Backup::finish() noexcept
+{
+    // free handle (error of the last step is returned here)
+    if (_backup) {
+        const int resultCode = sqlite3_backup_finish(_backup);
+        _backup = NULL;
+        if (_lastResultCode != SQLITE_DONE || resultCode != SQLITE_OK) {
+            _lastResultCode = resultCode;
+        }
+    }
+
+    return _lastResultCode == SQLITE_OK || _lastResultCode == SQLITE_DONE;
+}
+
+bool Backup::isOpen() const noexcept
+{
+    return _backup;
+}
+
+int Backup::lastResultCode() const noexcept
+{
+    return _lastResultCode;
+}
+
+int Backup::pageCount() const noexcept
+{
+    return _backup ? sqlite3_backup_pagecount(_backup) : 0;
+}
+
+int Backup::remaining() const noexcept
+{
+    return _backup ? sqlite3_backup_remaining(_backup) : 0;
+}
+
+int Backup::restarts() const noexcept
+{
+    return _restarts;
+}
+
+bool Backup::run(const int                       pagesPerStep,
+                 const std::chrono::milliseconds pause,
+                 const int                       maxRestarts,
+                 const int                       maxBusyRetries)
+{
+    // delay after locked step, it grows twice up to the maximum
+    std::chrono::milliseconds busyDelay(minBusyDelay);
+    int busyRetries = 0;
+
+    while (_backup) {
+        // source changed too often, so the rest is copied by one step
+        // (writers wait for all of it)
+        const int pages = (_restarts < maxRestarts && pagesPerStep >= 0)
+                ? std::max(pagesPerStep, 1) : -1;
+
+        const int resultCode = step(pages);
+        if (resultCode == SQLITE_DONE) {
+            break;
+        } else if (resultCode == SQLITE_BUSY || resultCode == SQLITE_LOCKED) {
+            // lock is held too long, so backup fails with its code
+            if (busyRetries >= maxBusyRetries) {
+                sqlite3_backup_finish(_backup);
+                _backup = NULL;
+                return false;
+            }
+
+            // database is locked by another connection, so wait for it
+            // (retry at once would spin)
+            ++busyRetries;
+            std::this_thread::sleep_for(std::max(busyDelay, pause));
+            busyDelay = std::min(busyDelay * 2, maxBusyDelay);
+            continue;
+        } else if (resultCode != SQLITE_OK) {
+            // other errors are fatal (SQLITE_LOCKED_SHAREDCACHE too, sqlite3
+            // returns it for all next steps)
+            finish();
+            return false;
+        }
+        busyDelay = minBusyDelay;
+        busyRetries = 0;
+
+        // report progress (handler can cancel backup)
+        if (_progress && !_progress(remaining(), pageCount())) {
+            _lastResultCode = SQLITE_ABORT;
+            sqlite3_backup_finish(_backup);
+            _backup = NULL;
+            return false;
+        }
+
+        // let writers of source work between steps
+        if (pause.count() > 0) {
+            std::this_thread::sleep_for(pause);
+        }
+    }
+
+    return finish();
+}
+
+void Backup::setProgressHandler(const ProgressHandler& handler)
+{
+    _progress = handler;
+}
+
+int Backup::step(const int pages) noexcept
+{
+    if (!_backup) {
+        return _lastResultCode = SQLITE_MISUSE;
+    }
+
+    _lastResultCode = sqlite3_backup_step(_backup, pages);
+
+    // copying starts again, if source was changed by another connection
+    // (changes of source connection are copied by sqlite3 itself)
+    const int remainingPages = sqlite3_backup_remaining(_backup);
+    if (_lastResultCode == SQLITE_OK && _remaining >= 0
+            && remainingPages > _remaining) {
+        ++_restarts;
+    }
+    if (_lastResultCode == SQLITE_OK || _lastResultCode == SQLITE_DONE) {
+        _remaining = remainingPages;
+    }
+
+    return _lastResultCode;
+}
+
+Backup& Backup::operator=(Backup&& backup) noexcept
+{
+    if (this != &backup) {
+        finish();
+
+        _backup = backup._backup;
+        _progress = std::move(backup._progress);
+        _lastResultCode = backup._lastResultCode;
+        _remaining = backup._remaining;
+        _restarts = backup._restarts;
+
+        backup._backup = NULL;
+    }
+
+    return *this;
+}
@@ -0,0 +1,193 @@
+#include "../include/blob_stream.h"
+
+#include <algorithm>
+
+#include "../include/sqlite3.h"
+
+
+BlobStream::BlobStream() noexcept
+    : _blob(NULL),
+      _rowId(0),
+      _size(0),
+      _position(0),
+      _lastResultCode(SQLITE_OK),
+      _writable(false)
+{}
+
+BlobStream::BlobStream(BlobStream&& stream) noexcept
+    : _blob(stream._blob),
+      _rowId(stream._rowId),
+      _size(stream._size),
+      _position(stream._position),
+      _lastResultCode(stream._lastResultCode),
+      _writable(stream._writable)
+{
+    stream._blob = NULL;
+    stream._size = 0;
+    stream._position = 0;
+}
+
+BlobStream::BlobStream(sqlite3_blob* const blob,
+                       const int64_t       rowId,
+                       const bool          writable) noexcept
+    : _blob(blob),
+      _rowId(rowId),
+      _size(blob ? sqlite3_blob_bytes(blob) : 0),
+      _position(0),
+      _lastResultCode(SQLITE_OK),
+      _writable(writable)
+{}
+
+BlobStream::~BlobStream() noexcept
+{
+    close();
+}
+
+bool BlobStream::close() noexcept
+{
+    // close handle (error of the last write is returned here)
+    if (_blob) {
+        _lastResultCode = sqlite3_blob_close(_blob);
+        _blob = NULL;
+        _size = 0;
+        _position = 0;
+    }
+
+    return _lastResultCode == SQLITE_OK;
+}
+
+bool BlobStream::isOpen() const noexcept
+{
+    return _blob;
+}
+
+bool BlobStream::isWritable() const noexcept
+{
+    return _writable;
+}
+
+int BlobStream::lastResultCode() const noexcept
+{
+    return _lastResultCode;
+}
+
+int BlobStream::position() const noexcept
+{
+    return _position;
+}
+
+int BlobStream::read(void* const buffer,
+                     const int   bytes) noexcept
+{
+    // read the next chunk (it is shorter at the end of blob)
+    const int count = std::min(std::max(bytes, 0), _size - _position);
+    if (!count) {
+        return 0;
+    } else if (!readAt(buffer, count, _position)) {
+        return -1;
+    }
+
+    _position += count;
+    return count;
+}
+
+bool BlobStream::readAt(void* const buffer,
+                        const int   bytes,
+                        const int   offset) noexcept
+{
+    if (!_blob) {
+        return false;
+    }
+
+    _lastResultCode = sqlite3_blob_read(_blob, buffer, bytes, offset);
+    return _lastResultCode == SQLITE_OK;
+}
+
+bool BlobStream::reopen(const int64_t rowId) noexcept
+{
+    if (!_blob) {
+        return false;
+    }
+
+    // move handle to the same column of another row (faster, than open)
+    _lastResultCode = sqlite3_blob_reopen(_blob, rowId);
+    if (_lastResultCode != SQLITE_OK) {
+        // handle can not be used after failed reopen
+        _size = 0;
+        _position = 0;
+        return false;
+    }
+
+    _rowId = rowId;
+    _size = sqlite3_blob_bytes(_blob);
+    _position = 0;
+
+    return true;
+}
+
+int64_t BlobStream::rowId() const noexcept
+{
+    return _rowId;
+}
+
+bool BlobStream::seek(const int offset) noexcept
+{
+    if (offset < 0 || offset > _size) {
+        return false;
+    }
+
+    _position = offset;
+    return true;
+}
+
+int BlobStream::size() const noexcept
+{
+    return _size;
+}
+
+int BlobStream::write(const void* const data,
+                      const int         bytes) noexcept
+{
+    // write the next chunk (blob can not grow, so rest of data is dropped)
+    const int count = std::min(std::max(bytes, 0), _size - _position);
+    if (!count) {
+        return 0;
+    } else if (!writeAt(data, count, _position)) {
+        return -1;
+    }
+
+    _position += count;
+    return count;
+}
+
+bool BlobStream::writeAt(const void* const data,
+                         const int         bytes,
+                         const int         offset) noexcept
+{
+    if (!_blob || !_writable) {
+        return false;
+    }
+
+    _lastResultCode = sqlite3_blob_write(_blob, data, bytes, offset);
+    return _lastResultCode == SQLITE_OK;
+}
+
+BlobStream& BlobStream::operator=(BlobStream&& stream) noexcept
+{
+    if (this != &stream) {
+        close();
+
+        _blob = stream._blob;
+        _rowId = stream._rowId;
+        _size = stream._size;
+        _position = stream._position;
+        _lastResultCode = stream._lastResultCode;
+        _writable = stream._writable;
+
+        stream._blob = NULL;
+        stream._size = 0;
+        stream._position = 0;
+    }
+
+    return *this;
+}
@@ -0,0 +1,447 @@
+#include "../include/bulk_inserter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../include/sqlite3.h"
+
+
+constexpr int BulkInserter::defaultCommitRows;
+constexpr int BulkInserter::defaultMaxRowsPerStatement;
+
+BulkInserter::BulkInserter(Connection&                     connection,
+                           const std::string&              table,
+                           const std::vector<std::string>& columns)
+    : _connection(connection),
+      _table(table),
+      _columns(columns),
+      _commitInterval(0),
+      _commitRows(defaultCommitRows),
+      _maxRowsPerStatement(defaultMaxRowsPerStatement),
+      _rebuildIndexes(false),
+      _rowsPerStatement(0),
+      _bufferedRows(0),
+      _rowsInTransaction(0),
+      _ownTransaction(false),
+      _started(false),
+      _failed(false),
+      _rowCount(0)
+{}
+
+BulkInserter::~BulkInserter() noexcept
+{
+    try {
+        finish();
+    } catch (...) {}
+}
+
+std::chrono::milliseconds BulkInserter::commitInterval() const noexcept
+{
+    return _commitInterval;
+}
+
+int BulkInserter::commitRows() const noexcept
+{
+    return _commitRows;
+}
+
+std::chrono::microseconds BulkInserter::elapsed() const noexcept
+{
+    // time from the first row to finish (or to the current moment)
+    if (!_started && _finishTime == Clock::time_point()) {
+        return std::chrono::microseconds(0);
+    }
+
+    const Clock::time_point end = _started ? Clock::now() : _finishTime;
+    return std::chrono::duration_cast
+            <std::chrono::microseconds>(end - _startTime);
+}
+
+bool BulkInserter::finish()
+{
+    if (!_started) {
+        return !_failed;
+    }
+
+    // insert buffered rows (rollback own transaction on error)
+    bool result = flush();
+    if (!result && _ownTransaction && _connection.inTransaction()) {
+        _connection.rollback();
+    }
+
+    // create dropped indexes again (even if loading failed)
+    result = restoreIndexes() && result;
+
+    // commit changes
+    if (_ownTransaction && _connection.inTransaction()) {
+        if (!result) {
+            _connection.rollback();
+        } else if (!_connection.commit()) {
+            result = fail("Error committing transaction: ");
+            _connection.rollback();
+        }
+    }
+
+    _statement.clear();
+    _started = false;
+    _finishTime = Clock::now();
+
+    return result;
+}
+
+bool BulkInserter::flush()
+{
+    if (_failed) {
+        return false;
+    }
+
+    // insert rest of rows with statement prepared for them
+    return !_bufferedRows || insertRows(_bufferedRows);
+}
+
+std::string BulkInserter::lastError() const
+{
+    return _lastError;
+}
+
+int BulkInserter::maxRowsPerStatement() const noexcept
+{
+    return _maxRowsPerStatement;
+}
+
+bool BulkInserter::rebuildIndexes() const noexcept
+{
+    return _rebuildIndexes;
+}
+
+uint64_t BulkInserter::rowCount() const noexcept
+{
+    return _rowCount;
+}
+
+double BulkInserter::rowsPerSecond() const noexcept
+{
+    const int64_t micros = elapsed().count();
+    return micros ? _rowCount * 1000000.0 / micros : 0.0;
+}
+
+void BulkInserter::setCommitInterval(const std::chrono::milliseconds value)
+noexcept
+{
+    _commitInterval = value;
+}
+
+void BulkInserter::setCommitRows(const int value) noexcept
+{
+    _commitRows = std::max(value, 0);
+}
+
+void BulkInserter::setMaxRowsPerStatement(const int value) noexcept
+{
+    // statement is prepared on the first row, so apply changes before it
+    if (!_started) {
+        _maxRowsPerStatement = std::max(value, 1);
+    }
+}
+
+void BulkInserter::setRebuildIndexes(const bool value) noexcept
+{
+    if (!_started) {
+        _rebuildIndexes = value;
+    }
+}
+
+bool BulkInserter::bindRows(const Statement& statement,
+                            const int        rows) noexcept
+{
+    const int count = rows * _columns.size();
+
+    // bind buffered values (they are alive until statement is executed)
+    for (int i = 0; i < count; ++i) {
+        const Value& value = _values[i];
+        bool bound;
+
+        switch (value.type) {
+        case ValueType::Integer:
+            bound = statement.bindInt64(i + 1, value.integer);
+            break;
+        case ValueType::Float:
+            bound = statement.bindDouble(i + 1, value.real);
+            break;
+        case ValueType::Text:
+            bound = statement.bindString(i + 1, value.bytes);
+            break;
+        case ValueType::Blob:
+            bound = statement.bindBlob(i + 1, value.bytes.data(),
+                                       value.bytes.size());
+            break;
+        case ValueType::Null:
+        default:
+            bound = statement.bindNull(i + 1);
+            break;
+        }
+
+        if (!bound) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string BulkInserter::buildQuery(const int rows) const
+{
+    // build list of columns and placeholders for one row
+    std::string columns;
+    std::string placeholders("(");
+    for (size_t i = 0; i < _columns.size(); ++i) {
+        if (i) {
+            columns += ',';
+            placeholders += ',';
+        }
+        columns += quoted(_columns[i]);
+        placeholders += '?';
+    }
+    placeholders += ')';
+
+    // build multi-row insert query
+    std::string result("INSERT INTO ");
+    result.append(quoted(_table)).append(" (").append(columns)
+            .append(") VALUES ");
+    result.reserve(result.size() + rows * (placeholders.size() + 1));
+    for (int i = 0; i < rows; ++i) {
+        if (i) {
+            result += ',';
+        }
+        result += placeholders;
+    }
+
+    return result;
+}
+
+bool BulkInserter::commitIfNeeded()
+{
+    // commit is driven by caller, when transaction is not ours
+    if (!_ownTransaction) {
+        return true;
+    }
+
+    const bool byRows = _commitRows && _rowsInTransaction >= _commitRows;
+    const bool byTime = _commitInterval.count()
+            && Clock::now() - _transactionTime >= _commitInterval;
+
+    // commit changes and start next transaction
+    if (byRows || byTime) {
+        if (!_connection.commit()) {
+            return fail("Error committing transaction: ");
+        } else if (!_connection.transaction()) {
+            return fail("Error starting transaction: ");
+        }
+
+        _rowsInTransaction = 0;
+        _transactionTime = Clock::now();
+    }
+
+    return true;
+}
+
+bool BulkInserter::dropIndexes()
+{
+    // read definitions of explicitly created indexes of the table
+    Statement stmt = _connection.prepare("SELECT name, sql FROM sqlite_master "
+                                         "WHERE type = 'index' AND "
+                                         "tbl_name = ? AND sql IS NOT NULL");
+    if (!stmt.isValid() || !stmt.bindAll(_table)) {
+        return fail("Error reading indexes: ");
+    }
+
+    for (const std::tuple<std::string, std::string>& index
+         : stmt.rows<std::string, std::string>()) {
+        _droppedIndexes.emplace_back(std::get<0>(index), std::get<1>(index));
+    }
+    stmt.clear();
+
+    // drop indexes (they will be created again on finish)
+    for (const std::pair<std::string, std::string>& index : _droppedIndexes) {
+        if (!_connection.execute("DROP INDEX " + quoted(index.first))) {
+            return fail("Error dropping index: ");
+        }
+    }
+
+    return true;
+}
+
+bool BulkInserter::fail(const std::string& message,
+                        const bool         withDbError)
+{
+    // keep the first error
+    if (!_failed) {
+        _failed = true;
+        _lastError = withDbError ? message + _connection.lastError()
+                                 : message;
+    }
+
+    return false;
+}
+
+bool BulkInserter::insertRows(const int rows)
+{
+    // prepare statement for partial chunk (full one is prepared on start)
+    Statement partial;
+    if (rows != _rowsPerStatement) {
+        partial = _connection.prepare(buildQuery(rows));
+        if (!partial.isValid()) {
+            return fail("Error preparing statement: ");
+        }
+    }
+
+    const Statement& statement = (rows != _rowsPerStatement)
+            ? partial : _statement;
+
+    // insert rows
+    const bool result = bindRows(statement, rows) && statement.execute();
+    statement.clearBindings();
+    if (!result) {
+        return fail("Error inserting rows: ");
+    }
+
+    _bufferedRows = 0;
+    _rowCount += rows;
+    _rowsInTransaction += rows;
+
+    return commitIfNeeded();
+}
+
+bool BulkInserter::restoreIndexes()
+{
+    bool result = true;
+
+    // create dropped indexes again (drop may be rolled back already)
+    for (const std::pair<std::string, std::string>& index : _droppedIndexes) {
+        int code;
+        const int exists = _connection.read<int>(
+                    "SELECT count(*) FROM sqlite_master "
+                    "WHERE type = 'index' AND name = ?", &code, index.first);
+        if (code != Connection::ReadSuccess
+                || (!exists && !_connection.execute(index.second))) {
+            result = fail("Error creating index: ");
+        }
+    }
+
+    _droppedIndexes.clear();
+    return result;
+}
+
+bool BulkInserter::rowAdded()
+{
+    // insert rows, when chunk is full
+    return ++_bufferedRows < _rowsPerStatement
+            || insertRows(_rowsPerStatement);
+}
+
+bool BulkInserter::start()
+{
+    if (!_connection.isOpen() || _columns.empty()) {
+        return fail("Error starting bulk insert: ");
+    }
+
+    _startTime = Clock::now();
+    _transactionTime = _startTime;
+
+    // use transaction of the caller, if any
+    _ownTransaction = !_connection.inTransaction();
+    if (_ownTransaction && !_connection.transaction()) {
+        return fail("Error starting transaction: ");
+    }
+
+    _started = true;
+
+    // drop indexes of the table for the time of loading
+    if (_rebuildIndexes && !dropIndexes()) {
+        return false;
+    }
+
+    // fit as many rows as allowed by the limit of host parameters
+    const int columns = _columns.size();
+    const int maxRows = _connection.limit(SQLITE_LIMIT_VARIABLE_NUMBER)
+            / columns;
+    _rowsPerStatement = std::max(std::min(_maxRowsPerStatement, maxRows), 1);
+    _values.resize(_rowsPerStatement * columns);
+
+    // prepare statement for full chunk of rows
+    _statement = _connection.prepare(buildQuery(_rowsPerStatement));
+    if (!_statement.isValid()) {
+        return fail("Error preparing statement: ");
+    }
+
+    return true;
+}
+
+BulkInserter::Value& BulkInserter::valueAt(const int column) noexcept
+{
+    return _values[_bufferedRows * _columns.size() + column];
+}
+
+void BulkInserter::store(Value& target, std::nullptr_t) noexcept
+{
+    target.type = ValueType::Null;
+}
+
+void BulkInserter::store(Value& target, const char* const value)
+{
+    if (value) {
+        target.type = ValueType::Text;
+        target.bytes.assign(value);
+    } else {
+        target.type = ValueType::Null;
+    }
+}
+
+void BulkInserter::store(Value& target, const std::string& value)
+{
+    target.type = ValueType::Text;
+    target.bytes.assign(value);
+}
+
+void BulkInserter::store(Value&                             target,
+                         const std::pair<const char*, int>& value)
+{
+    // negative size means zero-terminated text
+    if (value.first) {
+        target.type = ValueType::Text;
+        target.bytes.assign(value.first, value.second < 0
+                            ? std::strlen(value.first) : value.second);
+    } else {
+        target.type = ValueType::Null;
+    }
+}
+
+void BulkInserter::store(Value&                                      target,
+                         const std::pair<const unsigned char*, int>& value)
+{
+    target.type = ValueType::Blob;
+    target.bytes.assign(reinterpret_cast<const char*>(value.first),
+                        value.first ? value.second : 0);
+}
+
+void BulkInserter::store(Value&                            target,
+                         const std::vector<unsigned char>& value)
+{
+    target.type = ValueType::Blob;
+    target.bytes.assign(value.begin(), value.end());
+}
+
+std::string BulkInserter::quoted(const std::string& identifier)
+{
+    std::string result("\"");
+
+    // double quotes inside identifier
+    for (const char ch : identifier) {
+        if (ch == '"') {
+            result += ch;
+        }
+        result += ch;
+    }
+
+    return result += '"';
+}
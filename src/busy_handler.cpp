@@ -0,0 +1,250 @@
+#include "../include/busy_handler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <random>
+#include <thread>
+
+#include "../include/sqlite3.h"
+
+using Clock = std::chrono::steady_clock;
+using LockGuard = std::lock_guard<std::mutex>;
+using UniqueLock = std::unique_lock<std::mutex>;
+
+
+namespace {
+
+// start of the current busy event (handler is called by the waiting thread)
+thread_local Clock::time_point busyStart;
+
+struct UnlockNotification {
+    std::mutex              mutex;
+    std::condition_variable fired;
+    bool                    isFired;
+};
+
+void notifyUnlocked(void** arguments,
+                    int    count)
+{
+    for (int i = 0; i < count; ++i) {
+        UnlockNotification* const notification
+                = static_cast<UnlockNotification*>(arguments[i]);
+
+        LockGuard lock(notification->mutex);
+        notification->isFired = true;
+        notification->fired.notify_one();
+    }
+}
+
+}
+
+
+constexpr std::chrono::milliseconds BusyHandler::defaultTimeout;
+constexpr std::chrono::microseconds BusyHandler::defaultInitialDelay;
+constexpr std::chrono::microseconds BusyHandler::defaultMaxDelay;
+
+std::mutex BusyHandler::_mutex;
+
+std::unordered_map<sqlite3*, BusyHandler*> BusyHandler::_handlers;
+
+BusyHandler::BusyHandler(const Strategy                  strategy,
+                         const std::chrono::milliseconds timeout) noexcept
+    : _busyEvents(0),
+      _retries(0),
+      _timeouts(0),
+      _waitNanos(0),
+      _unlockWaits(0),
+      _unlockWaitNanos(0),
+      _timeout(timeout),
+      _initialDelay(defaultInitialDelay),
+      _maxDelay(defaultMaxDelay),
+      _strategy(strategy),
+      _unlockNotify(false)
+{}
+
+bool BusyHandler::attach(sqlite3* const db) noexcept
+{
+    int resultCode;
+
+    // set handler of SQLITE_BUSY (previous one is replaced), waiting by
+    // sqlite3 timeout is not counted in stats
+    switch (_strategy) {
+    case Strategy::Timeout:
+        resultCode = sqlite3_busy_timeout(db, static_cast<int>(
+                                              _timeout.count()));
+        break;
+    case Strategy::Backoff:
+        resultCode = sqlite3_busy_handler(db, &BusyHandler::backoff, this);
+        break;
+    default:
+        resultCode = sqlite3_busy_handler(db, NULL, NULL);
+        break;
+    }
+
+    // register handler for waiting of unlock notification
+    try {
+        LockGuard lock(_mutex);
+        _handlers[db] = this;
+    } catch (...) {
+        return false;
+    }
+
+    return resultCode == SQLITE_OK;
+}
+
+std::chrono::microseconds BusyHandler::initialDelay() const noexcept
+{
+    return _initialDelay;
+}
+
+std::chrono::microseconds BusyHandler::maxDelay() const noexcept
+{
+    return _maxDelay;
+}
+
+void BusyHandler::resetStats() noexcept
+{
+    _busyEvents.store(0, std::memory_order_relaxed);
+    _retries.store(0, std::memory_order_relaxed);
+    _timeouts.store(0, std::memory_order_relaxed);
+    _waitNanos.store(0, std::memory_order_relaxed);
+    _unlockWaits.store(0, std::memory_order_relaxed);
+    _unlockWaitNanos.store(0, std::memory_order_relaxed);
+}
+
+void BusyHandler::setDelays(const std::chrono::microseconds initial,
+                            const std::chrono::microseconds max) noexcept
+{
+    _initialDelay = std::max(initial, std::chrono::microseconds(1));
+    _maxDelay = std::max(max, _initialDelay);
+}
+
+void BusyHandler::setUnlockNotify(const bool enabled) noexcept
+{
+    _unlockNotify.store(enabled, std::memory_order_relaxed);
+}
+
+BusyHandler::Stats BusyHandler::stats() const noexcept
+{
+    Stats result;
+    result.busyEvents = _busyEvents.load(std::memory_order_relaxed);
+    result.retries = _retries.load(std::memory_order_relaxed);
+    result.timeouts = _timeouts.load(std::memory_order_relaxed);
+    result.waitNanos = _waitNanos.load(std::memory_order_relaxed);
+    result.unlockWaits = _unlockWaits.load(std::memory_order_relaxed);
+    result.unlockWaitNanos = _unlockWaitNanos.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+BusyHandler::Strategy BusyHandler::strategy() const noexcept
+{
+    return _strategy;
+}
+
+std::chrono::milliseconds BusyHandler::timeout() const noexcept
+{
+    return _timeout;
+}
+
+bool BusyHandler::unlockNotify() const noexcept
+{
+    return _unlockNotify.load(std::memory_order_relaxed);
+}
+
+void BusyHandler::detach(sqlite3* const db) noexcept
+{
+    sqlite3_busy_handler(db, NULL, NULL);
+
+    LockGuard lock(_mutex);
+    _handlers.erase(db);
+}
+
+bool BusyHandler::waitForUnlock(sqlite3* const db) noexcept
+{
+#ifdef SQLITE_ENABLE_UNLOCK_NOTIFY
+    // find handler of connection (it is done only after SQLITE_LOCKED)
+    BusyHandler* handler;
+    {
+        LockGuard lock(_mutex);
+        std::unordered_map<sqlite3*, BusyHandler*>::const_iterator it
+                = _handlers.find(db);
+        if (it == _handlers.cend() || !it->second->unlockNotify()) {
+            return false;
+        }
+        handler = it->second;
+    }
+
+    // callback is called at once, if blocking transaction is finished yet,
+    // and it is not registered, if waiting would cause deadlock
+    UnlockNotification notification;
+    notification.isFired = false;
+    if (sqlite3_unlock_notify(db, &notifyUnlocked, &notification)
+            != SQLITE_OK) {
+        return false;
+    }
+
+    const Clock::time_point start = Clock::now();
+    {
+        UniqueLock lock(notification.mutex);
+        notification.fired.wait(lock, [&notification] () {
+            return notification.isFired;
+        });
+    }
+
+    handler->_unlockWaits.fetch_add(1, std::memory_order_relaxed);
+    handler->_unlockWaitNanos.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>
+                (Clock::now() - start).count(), std::memory_order_relaxed);
+
+    return true;
+#else
+    // sqlite3 is built without unlock notification
+    (void)db;
+    return false;
+#endif
+}
+
+int BusyHandler::backoff(void*     context,
+                         const int count)
+{
+    thread_local std::minstd_rand random(std::random_device{}());
+
+    BusyHandler* const handler = static_cast<BusyHandler*>(context);
+    const Clock::time_point now = Clock::now();
+
+    // count is 0 on the first call for the locked operation
+    if (!count) {
+        busyStart = now;
+        handler->_busyEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // delay grows twice on every retry, half of it is random, so waiting
+    // connections do not retry at the same time
+    const int64_t maxDelay = handler->_maxDelay.count();
+    int64_t delay = handler->_initialDelay.count();
+    for (int i = 0; i < count && delay < maxDelay; ++i) {
+        delay *= 2;
+    }
+    delay = std::min(delay, maxDelay);
+    delay = delay / 2 + std::uniform_int_distribution<int64_t>
+            (0, delay / 2)(random);
+
+    // give up, if timeout is reached before the next retry
+    const std::chrono::microseconds waited
+            = std::chrono::duration_cast<std::chrono::microseconds>
+              (now - busyStart);
+    if (waited + std::chrono::microseconds(delay) > handler->_timeout) {
+        handler->_timeouts.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    std::this_thread::sleep_for(std::chrono::microseconds(delay));
+
+    handler->_retries.fetch_add(1, std::memory_order_relaxed);
+    handler->_waitNanos.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>
+                (Clock::now() - now).count(), std::memory_order_relaxed);
+
+    return 1;
+}
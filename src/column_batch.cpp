@@ -0,0 +1,295 @@
+#include "../include/column_batch.h"
+
+// disable asserts in non-debug mode
+#ifndef DEBUG
+#define NDEBUG
+#endif
+
+#include <cassert>
+
+#include "../include/sqlite3.h"
+
+
+ColumnBatch::ColumnBatch() noexcept
+    : _rowCount(0),
+      _maxRows(0),
+      _typed(false)
+{}
+
+std::pair<const unsigned char*, int>
+ColumnBatch::blob(const int column,
+                  const int row) const noexcept
+{
+    const std::pair<const char*, int> value = text(column, row);
+
+    return std::pair<const unsigned char*, int>
+    {reinterpret_cast<const unsigned char*>(value.first), value.second};
+}
+
+void ColumnBatch::clear() noexcept
+{
+    // keep allocated memory for the next rows
+    for (Column& column : _columns) {
+        column.integers.clear();
+        column.floats.clear();
+        column.offsets.assign(1, 0);
+        column.data.clear();
+        column.nulls.clear();
+    }
+
+    _rowCount = 0;
+}
+
+int ColumnBatch::columnCount() const noexcept
+{
+    return _columns.size();
+}
+
+const char* ColumnBatch::data(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+
+    return _columns[column].data.data();
+}
+
+const double* ColumnBatch::floats(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+    assert(_columns[column].type == Type::Float);
+
+    return _columns[column].floats.data();
+}
+
+const int64_t* ColumnBatch::integers(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+    assert(_columns[column].type == Type::Integer);
+
+    return _columns[column].integers.data();
+}
+
+bool ColumnBatch::isNull(const int column,
+                         const int row) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+    assert(row >= 0 && row < _rowCount);
+
+    return (_columns[column].nulls[row >> 6] >> (row & 63)) & 1;
+}
+
+const uint64_t* ColumnBatch::nullBitmap(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+
+    return _columns[column].nulls.data();
+}
+
+const uint32_t* ColumnBatch::offsets(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+
+    return _columns[column].offsets.data();
+}
+
+void ColumnBatch::reset() noexcept
+{
+    // columns will be found on the next fetch
+    _columns.clear();
+    _rowCount = 0;
+    _typed = false;
+}
+
+int ColumnBatch::rowCount() const noexcept
+{
+    return _rowCount;
+}
+
+std::pair<const char*, int> ColumnBatch::text(const int column,
+                                              const int row) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+    assert(row >= 0 && row < _rowCount);
+
+    const Column& col = _columns[column];
+    assert(col.type == Type::Text || col.type == Type::Blob);
+
+    // value is between offsets of the row and the next one
+    return std::pair<const char*, int>
+    {isNull(column, row) ? nullptr : col.data.data() + col.offsets[row],
+     col.offsets[row + 1] - col.offsets[row]};
+}
+
+ColumnBatch::Type ColumnBatch::type(const int column) const noexcept
+{
+    assert(column >= 0 && column < columnCount());
+
+    return _columns[column].type;
+}
+
+void ColumnBatch::appendRow(sqlite3_stmt* const statement)
+{
+    const int word = _rowCount >> 6;
+    const uint64_t bit = uint64_t(1) << (_rowCount & 63);
+
+    // types of columns are taken from the first row of the fetch
+    if (!_typed) {
+        for (size_t i = 0; i < _columns.size(); ++i) {
+            _columns[i].type = typeOf(statement, i);
+            reserve(_columns[i]);
+        }
+        _typed = true;
+    }
+
+    for (size_t i = 0; i < _columns.size(); ++i) {
+        Column& column = _columns[i];
+
+        // promote column, if value does not fit its type
+        const int valueType = sqlite3_column_type(statement, i);
+        if (valueType == SQLITE_FLOAT && column.type == Type::Integer) {
+            promote(column, Type::Float);
+        } else if (valueType == SQLITE_TEXT
+                   && (column.type == Type::Integer
+                       || column.type == Type::Float)) {
+            promote(column, Type::Text);
+        } else if (valueType == SQLITE_BLOB && column.type != Type::Blob) {
+            promote(column, Type::Blob);
+        }
+
+        // mark null value (value itself is zero or empty)
+        if (!(_rowCount & 63)) {
+            column.nulls.push_back(0);
+        }
+        const bool null = (valueType == SQLITE_NULL);
+        if (null) {
+            column.nulls[word] |= bit;
+        }
+
+        // convert value to the type of column
+        switch (column.type) {
+        case Type::Integer:
+            column.integers.push_back(null ? 0
+                                           : sqlite3_column_int64(statement,
+                                                                  i));
+            break;
+        case Type::Float:
+            column.floats.push_back(null ? 0.0
+                                         : sqlite3_column_double(statement,
+                                                                 i));
+            break;
+        case Type::Text:
+        case Type::Blob:
+        default:
+            if (!null) {
+                const void* const value = (column.type == Type::Text)
+                        ? sqlite3_column_text(statement, i)
+                        : sqlite3_column_blob(statement, i);
+                column.data.append(static_cast<const char*>(value),
+                                   sqlite3_column_bytes(statement, i));
+            }
+            column.offsets.push_back(column.data.size());
+            break;
+        }
+    }
+
+    ++_rowCount;
+}
+
+void ColumnBatch::prepare(sqlite3_stmt* const statement,
+                          const int           maxRows)
+{
+    // columns are kept, if batch is used for query with the same count of
+    // them, but types are found again by the first row
+    const size_t count = sqlite3_column_count(statement);
+    if (_columns.size() != count) {
+        _columns.clear();
+        _columns.resize(count);
+    }
+
+    clear();
+    _maxRows = maxRows;
+    _typed = false;
+
+    for (Column& column : _columns) {
+        column.nulls.reserve((maxRows + 63) >> 6);
+    }
+}
+
+void ColumnBatch::promote(Column&    column,
+                          const Type type)
+{
+    if (column.type == Type::Integer && type == Type::Float) {
+        column.floats.assign(column.integers.begin(), column.integers.end());
+        column.integers.clear();
+    } else if (column.type == Type::Integer || column.type == Type::Float) {
+        // number is converted to text as SQLite does it
+        char value[32];
+        column.offsets.assign(1, 0);
+        column.data.clear();
+        for (int row = 0; row < _rowCount; ++row) {
+            if (!((column.nulls[row >> 6] >> (row & 63)) & 1)) {
+                if (column.type == Type::Integer) {
+                    sqlite3_snprintf(sizeof(value), value, "%lld",
+                                     static_cast<sqlite3_int64>(
+                                         column.integers[row]));
+                } else {
+                    sqlite3_snprintf(sizeof(value), value, "%!.15g",
+                                     column.floats[row]);
+                }
+                column.data.append(value);
+            }
+            column.offsets.push_back(column.data.size());
+        }
+        column.integers.clear();
+        column.floats.clear();
+    }
+
+    // text is kept as is for blob
+    column.type = type;
+    reserve(column);
+}
+
+void ColumnBatch::reserve(Column& column)
+{
+    // reserve memory for values of the type
+    if (column.type == Type::Integer) {
+        column.integers.reserve(_maxRows);
+    } else if (column.type == Type::Float) {
+        column.floats.reserve(_maxRows);
+    } else {
+        column.offsets.reserve(_maxRows + 1);
+    }
+}
+
+ColumnBatch::Type ColumnBatch::typeOf(sqlite3_stmt* const statement,
+                                      const int           column) noexcept
+{
+    // type of the value
+    switch (sqlite3_column_type(statement, column)) {
+    case SQLITE_INTEGER:
+        return Type::Integer;
+    case SQLITE_FLOAT:
+        return Type::Float;
+    case SQLITE_BLOB:
+        return Type::Blob;
+    case SQLITE_TEXT:
+        return Type::Text;
+    default:
+        break;
+    }
+
+    // affinity of the declared type for null value (as SQLite finds it)
+    const char* declared = sqlite3_column_decltype(statement, column);
+    if (!declared || !*declared) {
+        return Type::Text;
+    } else if (!sqlite3_strlike("%INT%", declared, 0)) {
+        return Type::Integer;
+    } else if (!sqlite3_strlike("%CHAR%", declared, 0)
+               || !sqlite3_strlike("%CLOB%", declared, 0)
+               || !sqlite3_strlike("%TEXT%", declared, 0)) {
+        return Type::Text;
+    } else if (!sqlite3_strlike("%BLOB%", declared, 0)) {
+        return Type::Blob;
+    }
+
+    return Type::Float;
+}
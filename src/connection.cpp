@@ -4,6 +4,12 @@
 
 #include "../include/sqlite3.h"
 #include "../include/statement.h"
+#include "../include/thread_caching_allocator.h"
+
+// flag of sqlite3 3.30 (bundled header is older)
+#ifndef SQLITE_DIRECTONLY
+#define SQLITE_DIRECTONLY 0x000080000
+#endif
 
 
 std::mutex Connection::_mutex;
@@ -15,12 +21,22 @@ Connection::_libThreadMode(sqlite3_threadsafe()
 
 std::atomic_uint Connection::_openedConn(0);
 
+std::atomic_uint Connection::_openingConn(0);
+
+std::atomic<Connection::Allocator>
+Connection::_libAllocator(Connection::Allocator::Default);
+
+std::unique_ptr<char[]> Connection::_pageCache;
+
+std::unique_ptr<sqlite3_mem_methods> Connection::_defaultMemMethods;
+
 Connection::Connection(const Connection::OpenMode  openMode,
                        const Connection::CacheMode cacheMode)
     : _db(NULL),
       _openMode(openMode),
       _cacheMode(cacheMode),
-      _lastResultCode(-1)
+      _lastResultCode(-1),
+      _stmtCacheCapacity(0)
 {}
 
 Connection::Connection(const char* const dbName,
@@ -30,7 +46,8 @@ Connection::Connection(const char* const dbName,
       _dbName(dbName),
       _openMode(openMode),
       _cacheMode(cacheMode),
-      _lastResultCode(-1)
+      _lastResultCode(-1),
+      _stmtCacheCapacity(0)
 {}
 
 Connection::Connection(const std::string& dbName,
@@ -40,9 +57,29 @@ Connection::Connection(const std::string& dbName,
       _dbName(dbName),
       _openMode(openMode),
       _cacheMode(cacheMode),
-      _lastResultCode(-1)
+      _lastResultCode(-1),
+      _stmtCacheCapacity(0)
 {}
 
+Connection::Connection(Connection&& connection) noexcept
+    : _db(connection._db),
+      _dbName(std::move(connection._dbName)),
+      _openErrorMsg(std::move(connection._openErrorMsg)),
+      _openMode(connection._openMode),
+      _cacheMode(connection._cacheMode),
+      _lastResultCode(connection._lastResultCode),
+      _stmtCacheCapacity(connection._stmtCacheCapacity),
+      _stmtCache(std::move(connection._stmtCache)),
+      _profiler(std::move(connection._profiler)),
+      _busyHandler(std::move(connection._busyHandler))
+{
+    // reset moved object, so it will not close the database handle
+    connection._db = NULL;
+    connection._dbName.clear();
+    connection._openErrorMsg.clear();
+    connection._lastResultCode = -1;
+}
+
 Connection::~Connection()
 {
     close();
@@ -52,6 +89,23 @@ void Connection::close() noexcept
 {
     // check if connection is opened
     if (_db) {
+        // finalize cached statements
+        if (_stmtCache) {
+            _stmtCache->close();
+            _stmtCache.reset();
+        }
+
+        // forget handler of the closed connection
+        if (_busyHandler) {
+            BusyHandler::detach(_db);
+        }
+
+        // stop profiling (statements, that are not finalized yet, keep
+        // zombie connection and must not call freed profiler)
+        if (_profiler) {
+            QueryProfiler::detach(_db);
+        }
+
         // close connection
         sqlite3_close_v2(_db);
         _db = NULL;
@@ -65,6 +119,31 @@ void Connection::close() noexcept
     }
 }
 
+Backup Connection::backupTo(Connection&        destination,
+                            const std::string& destinationName,
+                            const std::string& sourceName)
+{
+    // try start backup (it is not opened on error, error code is kept)
+    if (!_db || !destination._db) {
+        return Backup(NULL, SQLITE_MISUSE);
+    }
+
+    sqlite3_backup* const backup
+            = sqlite3_backup_init(destination._db, destinationName.c_str(),
+                                  _db, sourceName.c_str());
+    if (!backup) {
+        destination._lastResultCode = sqlite3_errcode(destination._db);
+        return Backup(NULL, destination._lastResultCode);
+    }
+
+    return Backup(backup, SQLITE_OK);
+}
+
+std::shared_ptr<BusyHandler> Connection::busyHandler() const noexcept
+{
+    return _busyHandler;
+}
+
 bool Connection::commit() noexcept
 {
     return execute("COMMIT");
@@ -94,13 +173,20 @@ std::string Connection::databaseName() const noexcept
 
 bool Connection::open()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     // check connection is opened
     if (_db) {
         // connection is already opened
         return true;
     } else {
+        // register open (library is not configured, until it is finished),
+        // but do not keep lock, so databases are opened concurrently (lock
+        // is kept for single-thread sqlite3, which has no own mutexes)
+        std::unique_lock<std::mutex> lock(_mutex);
+        _openingConn.fetch_add(1, std::memory_order_acq_rel);
+        if (_libThreadMode.load(std::memory_order_acquire)
+                != ThreadMode::SingleThread && sqlite3_threadsafe()) {
+            lock.unlock();
+        }
 
         // try open database
         switch (_openMode) {
@@ -108,7 +194,8 @@ bool Connection::open()
             _lastResultCode = openTemporaryDb();
             break;
         case OpenMode::InMemory:
-            _lastResultCode = openTemporaryDb();
+            _lastResultCode = openInMemoryDb();
+            break;
         default:
             _lastResultCode = openRegularDb();
             break;
@@ -117,6 +204,21 @@ bool Connection::open()
         // chek is connection opened
         if (_lastResultCode == SQLITE_OK) {
             _openedConn.fetch_add(1, std::memory_order_release);
+            _openingConn.fetch_sub(1, std::memory_order_release);
+
+            // create statement cache (it keeps nothing, if capacity is 0)
+            _stmtCache = std::make_shared<StatementCache>
+                    (_db, _stmtCacheCapacity);
+
+            // start profiling (profiler is not used, if it is not set)
+            if (_profiler) {
+                _profiler->attach(_db);
+            }
+
+            // set waiting strategy for locked database
+            if (_busyHandler) {
+                _busyHandler->attach(_db);
+            }
         } else {
 
             // read and save last error
@@ -126,12 +228,39 @@ bool Connection::open()
             // release sqlite3 pointer
             sqlite3_close_v2(_db);
             _db = NULL;
+            _openingConn.fetch_sub(1, std::memory_order_release);
         }
     }
 
     return _lastResultCode == SQLITE_OK;
 }
 
+BlobStream Connection::openBlob(const std::string& table,
+                                const std::string& column,
+                                const int64_t      rowId,
+                                const bool         writable,
+                                const std::string& database)
+{
+    // try open handle of blob (stream is not opened on error)
+    sqlite3_blob* blob = NULL;
+    if (_db) {
+        _lastResultCode = sqlite3_blob_open(_db, database.c_str(),
+                                            table.c_str(), column.c_str(),
+                                            rowId, writable, &blob);
+        if (_lastResultCode != SQLITE_OK) {
+            sqlite3_blob_close(blob);
+            blob = NULL;
+        }
+    }
+
+    return BlobStream(blob, rowId, writable);
+}
+
+bool Connection::inTransaction() const noexcept
+{
+    return _db && !sqlite3_get_autocommit(_db);
+}
+
 bool Connection::isOpen() const noexcept
 {
     return _db;
@@ -164,14 +293,28 @@ int Connection::lastResultCode() const noexcept
     return _lastResultCode;
 }
 
+int Connection::limit(const int id) const noexcept
+{
+    return _db ? sqlite3_limit(_db, id, -1) : -1;
+}
+
 Statement Connection::prepare(const char* const query,
                               const int         length) noexcept
 {
     if (_db) {
         sqlite3_stmt *stmt;
-        if ((_lastResultCode
-             = sqlite3_prepare_v2(_db, query, length,
-                                  &stmt, NULL)) == SQLITE_OK) {
+        _lastResultCode = sqlite3_prepare_v2(_db, query, length, &stmt, NULL);
+
+        // schema of shared cache is locked by another connection, so wait
+        // for unlock notification (if it is enabled) and prepare again
+        while (_lastResultCode == SQLITE_LOCKED
+               && sqlite3_extended_errcode(_db) == SQLITE_LOCKED_SHAREDCACHE
+               && BusyHandler::waitForUnlock(_db)) {
+            _lastResultCode = sqlite3_prepare_v2(_db, query, length, &stmt,
+                                                 NULL);
+        }
+
+        if (_lastResultCode == SQLITE_OK) {
             return Statement(stmt);
         }
     }
@@ -184,83 +327,50 @@ Statement Connection::prepare(const std::string& query) noexcept
     return prepare(query.c_str(), query.length());
 }
 
-double Connection::readDouble(const std::string& query,
-                              int*               resultCode) noexcept
+CachedStatement Connection::prepareCached(const std::string& query)
 {
-    double result = 0.0;
+    // take statement from the cache (or prepare it)
+    if (_stmtCache) {
+        return _stmtCache->acquire(query, _lastResultCode);
+    }
 
-    // try read double
-    const int code = readValue(query, [&result] (sqlite3_stmt* stmt) -> void {
-        result = sqlite3_column_double(stmt, 0);
-    });
+    return CachedStatement();
+}
 
-    // save result code, if pointer is valid
-    if (resultCode) {
-        *resultCode = code;
-    }
+std::shared_ptr<QueryProfiler> Connection::profiler() const noexcept
+{
+    return _profiler;
+}
 
-    // return result
-    return result;
+double Connection::readDouble(const std::string& query,
+                              int*               resultCode) noexcept
+{
+    return read<double>(query, resultCode);
 }
 
 int64_t Connection::readInt64(const std::string& query,
                               int*               resultCode) noexcept
 {
-    int64_t result = 0;
-
-    // try read int64 and return result
-    const int code = readValue(query, [&result] (sqlite3_stmt* stmt) -> void {
-        result = sqlite3_column_int64(stmt, 0);
-    });
-
-    // save result code, if pointer is valid
-    if (resultCode) {
-        *resultCode = code;
-    }
-
-    // return result
-    return result;
+    return read<int64_t>(query, resultCode);
 }
 
 std::string Connection::readString(const std::string& query,
                                    int*               resultCode)
 {
-    std::string result;
-
-    // try read string and return result
-    const int code = readValue(query, [&result] (sqlite3_stmt* stmt) -> void {
-        result.assign(reinterpret_cast<const char*>
-                      (sqlite3_column_text(stmt, 0)),
-                      sqlite3_column_bytes(stmt, 0));
-    });
-
-    // save result code, if pointer is valid
-    if (resultCode) {
-        *resultCode = code;
-    }
-
-    // return result
-    return result;
+    return read<std::string>(query, resultCode);
 }
 
 std::u16string Connection::readString16(const std::string& query,
                                         int*               resultCode)
 {
-    std::u16string result;
-
-    // try read string and return result
-    const int code = readValue(query, [&result] (sqlite3_stmt* stmt) -> void {
-        result = reinterpret_cast<const char16_t*>
-            (sqlite3_column_text16(stmt, 0));
-    });
+    return read<std::u16string>(query, resultCode);
+}
 
-    // save result code, if pointer is valid
-    if (resultCode) {
-        *resultCode = code;
+void Connection::resetStatementCacheStats() noexcept
+{
+    if (_stmtCache) {
+        _stmtCache->resetStats();
     }
-
-    // return result
-    return result;
 }
 
 bool Connection::rollback() noexcept
@@ -268,6 +378,31 @@ bool Connection::rollback() noexcept
     return execute("ROLLBACK");
 }
 
+void Connection::setBusyHandler(const std::shared_ptr<BusyHandler>& handler)
+noexcept
+{
+    // switch handler of the opened connection before old one is freed
+    if (_db) {
+        if (handler) {
+            handler->attach(_db);
+        } else {
+            BusyHandler::detach(_db);
+        }
+    }
+
+    _busyHandler = handler;
+}
+
+bool Connection::setBusyTimeout(const int milliseconds) noexcept
+{
+    if (!_db) {
+        return false;
+    }
+
+    _lastResultCode = sqlite3_busy_timeout(_db, milliseconds);
+    return _lastResultCode == SQLITE_OK;
+}
+
 void Connection::setDbName(const std::string& dbPath)
 {
     // check if connection is open and assign value
@@ -276,6 +411,63 @@ void Connection::setDbName(const std::string& dbPath)
     }
 }
 
+bool Connection::setLookaside(const int slotSize,
+                              const int slotCount) noexcept
+{
+    if (!_db) {
+        return false;
+    }
+
+    // memory is allocated by sqlite3 (it fails, if lookaside is in use)
+    _lastResultCode = sqlite3_db_config(_db, SQLITE_DBCONFIG_LOOKASIDE,
+                                        static_cast<void*>(NULL),
+                                        slotSize, slotCount);
+    return _lastResultCode == SQLITE_OK;
+}
+
+void Connection::setProfiler(const std::shared_ptr<QueryProfiler>& profiler)
+noexcept
+{
+    // switch callback of the opened connection before old profiler is freed
+    if (_db) {
+        if (profiler) {
+            profiler->attach(_db);
+        } else {
+            QueryProfiler::detach(_db);
+        }
+    }
+
+    _profiler = profiler;
+}
+
+void Connection::setStatementCacheCapacity(const int capacity) noexcept
+{
+    _stmtCacheCapacity = (capacity > 0) ? capacity : 0;
+
+    // apply new capacity to the opened connection
+    if (_stmtCache) {
+        _stmtCache->setCapacity(_stmtCacheCapacity);
+    }
+}
+
+int Connection::statementCacheCapacity() const noexcept
+{
+    return _stmtCacheCapacity;
+}
+
+StatementCache::Stats Connection::statementCacheStats() const noexcept
+{
+    StatementCache::Stats result = StatementCache::Stats();
+    result.capacity = _stmtCacheCapacity;
+
+    // read statistics of the cache (if any)
+    if (_stmtCache) {
+        result = _stmtCache->stats();
+    }
+
+    return result;
+}
+
 bool Connection::transaction() noexcept
 {
     return execute("BEGIN");
@@ -289,14 +481,20 @@ Connection& Connection::operator=(Connection&& connection) noexcept
         // move assign object vars
         _db = connection._db;
         _dbName = std::move(connection._dbName);
-        _openErrorMsg = std::move(connection._dbName);
+        _openErrorMsg = std::move(connection._openErrorMsg);
         _openMode = connection._openMode;
         _cacheMode = connection._cacheMode;
+        _lastResultCode = connection._lastResultCode;
+        _stmtCacheCapacity = connection._stmtCacheCapacity;
+        _stmtCache = std::move(connection._stmtCache);
+        _profiler = std::move(connection._profiler);
+        _busyHandler = std::move(connection._busyHandler);
 
         // reset moved object to default value
         connection._db = NULL;
         connection._dbName.clear();
         connection._openErrorMsg.clear();
+        connection._lastResultCode = -1;
     }
 
     return *this;
@@ -333,6 +531,128 @@ int Connection::openedConnNumber() noexcept
     return _openedConn.load(std::memory_order_acquire);
 }
 
+int Connection::setAllocator(const Allocator value)
+{
+    // check opened connection count
+    if (_openedConn > 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+
+    if (value == _libAllocator.load(std::memory_order_acquire)) {
+        return SQLITE_OK;
+    }
+
+    // save built-in allocator, so it can be restored later
+    if (!_defaultMemMethods) {
+        std::unique_ptr<sqlite3_mem_methods> methods(new sqlite3_mem_methods);
+        const int resultCode = tryConfig(SQLITE_CONFIG_GETMALLOC,
+                                         methods.get());
+        if (resultCode != SQLITE_OK) {
+            return resultCode;
+        }
+        _defaultMemMethods = std::move(methods);
+    }
+
+    // try configure allocator (sqlite3 copies the methods)
+    const int resultCode = tryConfig(SQLITE_CONFIG_MALLOC,
+                                     value == Allocator::ThreadCaching
+                                     ? ThreadCachingAllocator::methods()
+                                     : _defaultMemMethods.get());
+
+    // if success, change current allocator
+    if (resultCode == SQLITE_OK) {
+        _libAllocator.store(value, std::memory_order_release);
+    }
+
+    return resultCode;
+}
+
+int Connection::setDefaultLookaside(const int slotSize,
+                                    const int slotCount)
+{
+    // check opened connection count
+    if (_openedConn > 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+
+    // it is used by connections opened later (0 slots disable lookaside)
+    return tryConfig(SQLITE_CONFIG_LOOKASIDE, slotSize, slotCount);
+}
+
+int Connection::setMemoryStatus(const bool enabled)
+{
+    // check opened connection count
+    if (_openedConn > 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+
+    // disabled status removes a lock from every allocation
+    return tryConfig(SQLITE_CONFIG_MEMSTATUS, enabled ? 1 : 0);
+}
+
+int Connection::setPageCache(const int pageSize,
+                             const int pageCount)
+{
+    // check opened connection count
+    if (_openedConn > 0 || pageSize < 0 || pageCount < 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(_mutex);
+
+    // 0 pages return page cache to the heap
+    if (!pageSize || !pageCount) {
+        const int resultCode = tryConfig(SQLITE_CONFIG_PAGECACHE,
+                                         static_cast<void*>(NULL), 0, 0);
+        if (resultCode == SQLITE_OK) {
+            _pageCache.reset();
+        }
+        return resultCode;
+    }
+
+    // slot keeps page and header of page cache
+    int headerSize = 0;
+    int resultCode = tryConfig(SQLITE_CONFIG_PCACHE_HDRSZ, &headerSize);
+    if (resultCode != SQLITE_OK) {
+        return resultCode;
+    }
+    const int slotSize = (pageSize + headerSize + 7) & ~7;
+
+    // sqlite3 uses the buffer until it is configured again, so the old
+    // buffer is freed only after that
+    std::unique_ptr<char[]> buffer(new char[static_cast<size_t>(slotSize)
+                                            * pageCount]);
+    resultCode = tryConfig(SQLITE_CONFIG_PAGECACHE,
+                           static_cast<void*>(buffer.get()),
+                           slotSize, pageCount);
+    if (resultCode == SQLITE_OK) {
+        _pageCache = std::move(buffer);
+    }
+
+    return resultCode;
+}
+
+Connection::Allocator Connection::allocator() noexcept
+{
+    return _libAllocator.load(std::memory_order_acquire);
+}
+
+int64_t Connection::memoryUsed() noexcept
+{
+    return sqlite3_memory_used();
+}
+
+int64_t Connection::memoryHighwater(const bool reset) noexcept
+{
+    return sqlite3_memory_highwater(reset ? 1 : 0);
+}
+
 int Connection::getOpenFlags() const noexcept
 {
     int resFlags = 0;
@@ -391,9 +711,10 @@ int Connection::openInMemoryDb()
 
     uriStr += (_cacheMode == CacheMode::Private) ? "private" : "shared";
 
-    // try open in-memory db and return result
+    // try open in-memory db and return result (cache mode of URI is used)
     return _lastResultCode = sqlite3_open_v2(uriStr.c_str(), &_db,
-                                             SQLITE_OPEN_URI, NULL);
+                                             getOpenFlags() | SQLITE_OPEN_URI,
+                                             NULL);
 }
 
 int Connection::openRegularDb()
@@ -410,44 +731,36 @@ int Connection::openTemporaryDb()
     return _lastResultCode = sqlite3_open_v2("", &_db, getOpenFlags(), NULL);
 }
 
-int Connection::readValue(const std::string&                  query,
-                          std::function<void (sqlite3_stmt*)> readLambda)
+bool Connection::registerFunction(const std::string& name,
+                                  const int          arity,
+                                  const bool         deterministic,
+                                  const bool         directOnly,
+                                  void* const        function,
+                                  void (*call)(sqlite3_context*, int,
+                                               sqlite3_value**),
+                                  void (*step)(sqlite3_context*, int,
+                                               sqlite3_value**),
+                                  void (*finalize)(sqlite3_context*),
+                                  void (*destroy)(void*)) noexcept
 {
-    // check connection
-    if (_db) {
-        // try prepare statement
-        sqlite3_stmt *stmt;
-        _lastResultCode = sqlite3_prepare_v2(_db, query.c_str(),
-                                            query.length(), &stmt, NULL);
-
-        // if success, try read data (or set the error code)
-        if (_lastResultCode == SQLITE_OK) {
-            int resultCode;   // code for return
-
-            if (sqlite3_column_count(stmt)) {
-                if (sqlite3_step(stmt) == SQLITE_ROW) {
-                    // check value type and read it (if it is not NULL)
-                    if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
-                        readLambda(stmt);
-                        resultCode = ReadSuccess;
-                    } else {
-                        resultCode = NullValue;
-                    }
-                } else {
-                    resultCode = EmptyData;
-                }
-            } else {
-                resultCode = NoData;
-            }
-
-            // delete prepared statement and return result code
-            sqlite3_finalize(stmt);
-            return resultCode;
+    // function object is freed here, if it is not passed to sqlite3
+    if (!_db) {
+        if (destroy) {
+            destroy(function);
         }
+        _lastResultCode = SQLITE_MISUSE;
+        return false;
     }
 
-    // return error code
-    return _lastResultCode;
+    // sqlite3 frees function object, when it is replaced, deleted or failed
+    // to register (or when connection is closed)
+    const int flags = SQLITE_UTF8
+            | (deterministic ? SQLITE_DETERMINISTIC : 0)
+            | (directOnly ? SQLITE_DIRECTONLY : 0);
+    _lastResultCode = sqlite3_create_function_v2(_db, name.c_str(), arity,
+                                                 flags, function, call, step,
+                                                 finalize, destroy);
+    return _lastResultCode == SQLITE_OK;
 }
 
 int Connection::configOptionFor(const ThreadMode value) noexcept
@@ -471,17 +784,25 @@ int Connection::configOptionFor(const ThreadMode value) noexcept
 
 int Connection::tryConfigThreadMode(const int option) noexcept
 {
-    if (_openedConn > 0) {
+    return tryConfig(option);
+}
+
+template <typename... Args>
+int Connection::tryConfig(const int     option,
+                          const Args... args) noexcept
+{
+    // it is called under lock, so no connection starts opening here
+    if (_openedConn > 0 || _openingConn > 0) {
         return -1;
     }
 
     // try configure sqlite3 library
-    int resultCode = sqlite3_config(option);
+    int resultCode = sqlite3_config(option, args...);
 
     // if sqlite3 library is initialized, try shutdown and configure it
     if (resultCode == SQLITE_MISUSE
             && (resultCode = sqlite3_shutdown()) == SQLITE_OK) {
-        resultCode = sqlite3_config(option);
+        resultCode = sqlite3_config(option, args...);
     }
 
     // return result
@@ -1,11 +1,101 @@
 #include "../include/connection_config.h"
 
+#include <utility>
+
+#include "../include/sqlite3.h"
+
+
+constexpr int64_t ConnectionConfig::notSet;
 
 ConnectionConfig::ConnectionConfig()
-    : _cacheMode(Connection::defaultCacheMode),
-      _openMode(Connection::defaultOpenMode)
+    : _busyTimeout(notSet),
+      _cacheSize(notSet),
+      _lookasideSlotCount(notSet),
+      _lookasideSlotSize(notSet),
+      _mmapSize(notSet),
+      _pageSize(notSet),
+      _walAutocheckpoint(notSet),
+      _cacheMode(Connection::defaultCacheMode),
+      _openMode(Connection::defaultOpenMode),
+      _journalMode(JournalMode::NotSet),
+      _synchronous(Synchronous::NotSet),
+      _tempStore(TempStore::NotSet)
 {}
 
+bool ConnectionConfig::addMigration(const int          version,
+                                    const std::string& script)
+{
+    // version 0 is version of empty database, each step has own version
+    if (version <= 0 || script.empty()) {
+        return false;
+    }
+
+    return _migrations.emplace(version, script).second;
+}
+
+bool ConnectionConfig::applyPreset(const std::string& name)
+{
+    if (name == "durable") {
+        applyPreset(Preset::Durable);
+    } else if (name == "fast-ingest") {
+        applyPreset(Preset::FastIngest);
+    } else if (name == "read-mostly") {
+        applyPreset(Preset::ReadMostly);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+void ConnectionConfig::applyPreset(const Preset value)
+{
+    // settings, which are not used by preset, are not changed
+    switch (value) {
+    case Preset::Durable:
+        _journalMode = JournalMode::Wal;
+        _synchronous = Synchronous::Full;
+        _busyTimeout = 5000;
+        _walAutocheckpoint = 1000;
+        break;
+    case Preset::FastIngest:
+        // WAL is synced by checkpoints only: the last commits can be lost
+        // after power loss, but database is consistent (OFF could corrupt)
+        _journalMode = JournalMode::Wal;
+        _synchronous = Synchronous::Normal;
+        _tempStore = TempStore::Memory;
+        _cacheSize = -64 * 1024;
+        _busyTimeout = 5000;
+        _walAutocheckpoint = 10000;
+        break;
+    case Preset::ReadMostly:
+        _journalMode = JournalMode::Wal;
+        _synchronous = Synchronous::Normal;
+        _tempStore = TempStore::Memory;
+        _cacheSize = -32 * 1024;
+        _mmapSize = 256 * 1024 * 1024;
+        _busyTimeout = 5000;
+        break;
+    }
+
+    updateTuningPragmas();
+}
+
+int64_t ConnectionConfig::busyTimeout() const noexcept
+{
+    return _busyTimeout;
+}
+
+int64_t ConnectionConfig::cacheSize() const noexcept
+{
+    return _cacheSize;
+}
+
+void ConnectionConfig::clearMigrations() noexcept
+{
+    _migrations.clear();
+}
+
 std::string ConnectionConfig::databaseName() const
 {
     return _databaseName;
@@ -33,7 +123,44 @@ bool ConnectionConfig::equal(const ConnectionConfig& config) const noexcept
             && _openMode == config.openMode()
             && !_createSchemaScript.compare(config.createSchemaScript())
             && !_configConnectionScript.compare(
-                config.configConnectionScript());
+                config.configConnectionScript())
+            && _busyTimeout == config.busyTimeout()
+            && _cacheSize == config.cacheSize()
+            && _lookasideSlotCount == config.lookasideSlotCount()
+            && _lookasideSlotSize == config.lookasideSlotSize()
+            && _mmapSize == config.mmapSize()
+            && _pageSize == config.pageSize()
+            && _walAutocheckpoint == config.walAutocheckpoint()
+            && _journalMode == config.journalMode()
+            && _synchronous == config.synchronous()
+            && _tempStore == config.tempStore()
+            && _migrations == config.migrations();
+}
+
+ConnectionConfig::JournalMode ConnectionConfig::journalMode() const noexcept
+{
+    return _journalMode;
+}
+
+int64_t ConnectionConfig::lookasideSlotCount() const noexcept
+{
+    return _lookasideSlotCount;
+}
+
+int64_t ConnectionConfig::lookasideSlotSize() const noexcept
+{
+    return _lookasideSlotSize;
+}
+
+const std::map<int, std::string>& ConnectionConfig::migrations()
+const noexcept
+{
+    return _migrations;
+}
+
+int64_t ConnectionConfig::mmapSize() const noexcept
+{
+    return _mmapSize;
 }
 
 Connection::OpenMode ConnectionConfig::openMode() const noexcept
@@ -41,6 +168,57 @@ Connection::OpenMode ConnectionConfig::openMode() const noexcept
     return _openMode;
 }
 
+int64_t ConnectionConfig::pageSize() const noexcept
+{
+    return _pageSize;
+}
+
+void ConnectionConfig::resetTuning()
+{
+    _busyTimeout = notSet;
+    _cacheSize = notSet;
+    _lookasideSlotCount = notSet;
+    _lookasideSlotSize = notSet;
+    _mmapSize = notSet;
+    _pageSize = notSet;
+    _walAutocheckpoint = notSet;
+    _journalMode = JournalMode::NotSet;
+    _synchronous = Synchronous::NotSet;
+    _tempStore = TempStore::NotSet;
+
+    _tuningPragmas.clear();
+}
+
+int ConnectionConfig::schemaVersion() const noexcept
+{
+    // version of database after the last migration step
+    return _migrations.empty() ? 0 : _migrations.crbegin()->first;
+}
+
+bool ConnectionConfig::setBusyTimeout(const int64_t milliseconds)
+{
+    if (milliseconds != notSet && (milliseconds < 0
+            || milliseconds > std::numeric_limits<int>::max())) {
+        return false;
+    }
+
+    _busyTimeout = milliseconds;
+    return true;
+}
+
+bool ConnectionConfig::setCacheSize(const int64_t value)
+{
+    // negative value is size in KiB, positive one is count of pages
+    if (value != notSet && (value < std::numeric_limits<int>::min()
+            || value > std::numeric_limits<int>::max())) {
+        return false;
+    }
+
+    _cacheSize = value;
+    updateTuningPragmas();
+    return true;
+}
+
 void ConnectionConfig::setDatabaseName(const std::string& databaseName)
 {
     _databaseName = databaseName;
@@ -61,8 +239,178 @@ void ConnectionConfig::setCreateSchemaScript(const std::string& script)
     _createSchemaScript = script;
 }
 
+void ConnectionConfig::setJournalMode(const JournalMode value)
+{
+    _journalMode = value;
+    updateTuningPragmas();
+}
+
+bool ConnectionConfig::setLookaside(const int64_t slotSize,
+                                    const int64_t slotCount)
+{
+    // both values are set or not set together (0 slots disable lookaside)
+    if ((slotSize == notSet) != (slotCount == notSet)) {
+        return false;
+    } else if (slotSize != notSet && (slotSize < 0 || slotCount < 0
+            || slotSize > 65536 || slotCount > 1000000)) {
+        return false;
+    }
+
+    _lookasideSlotSize = slotSize;
+    _lookasideSlotCount = slotCount;
+    return true;
+}
+
+bool ConnectionConfig::setMmapSize(const int64_t bytes)
+{
+    if (bytes != notSet && bytes < 0) {
+        return false;
+    }
+
+    _mmapSize = bytes;
+    updateTuningPragmas();
+    return true;
+}
+
 void ConnectionConfig::setOpenMode(const Connection::OpenMode value) noexcept
 {
     _openMode = value;
 }
 
+bool ConnectionConfig::setPageSize(const int64_t bytes)
+{
+    // page size is power of two between 512 and 65536
+    if (bytes != notSet && (bytes < 512 || bytes > 65536
+                            || (bytes & (bytes - 1)))) {
+        return false;
+    }
+
+    _pageSize = bytes;
+    updateTuningPragmas();
+    return true;
+}
+
+void ConnectionConfig::setSynchronous(const Synchronous value)
+{
+    _synchronous = value;
+    updateTuningPragmas();
+}
+
+void ConnectionConfig::setTempStore(const TempStore value)
+{
+    _tempStore = value;
+    updateTuningPragmas();
+}
+
+bool ConnectionConfig::setWalAutocheckpoint(const int64_t pages)
+{
+    // 0 or negative value disables automatic checkpoints
+    if (pages != notSet && (pages < std::numeric_limits<int>::min()
+            || pages > std::numeric_limits<int>::max())) {
+        return false;
+    }
+
+    _walAutocheckpoint = pages;
+    updateTuningPragmas();
+    return true;
+}
+
+ConnectionConfig::Synchronous ConnectionConfig::synchronous() const noexcept
+{
+    return _synchronous;
+}
+
+ConnectionConfig::TempStore ConnectionConfig::tempStore() const noexcept
+{
+    return _tempStore;
+}
+
+bool ConnectionConfig::tune(Connection& connection) const noexcept
+{
+    // lookaside can be changed only before connection allocates memory
+    if (_lookasideSlotSize != notSet
+            && !connection.setLookaside(
+                static_cast<int>(_lookasideSlotSize),
+                static_cast<int>(_lookasideSlotCount))) {
+        return false;
+    }
+
+    if (_busyTimeout != notSet
+            && !connection.setBusyTimeout(static_cast<int>(_busyTimeout))) {
+        return false;
+    }
+
+    // each pragma is prepared alone (pragma, that sets value, may return
+    // the new value as a row, that is not needed)
+    for (const std::string& pragma : _tuningPragmas) {
+        Statement stmt = connection.prepare(pragma);
+        if (!stmt.isValid()
+                || (!stmt.execute() && stmt.lastErrorCode() != SQLITE_ROW)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string ConnectionConfig::tuningScript() const
+{
+    std::string result;
+    for (const std::string& pragma : _tuningPragmas) {
+        result.append(pragma).append(";");
+    }
+
+    return result;
+}
+
+int64_t ConnectionConfig::walAutocheckpoint() const noexcept
+{
+    return _walAutocheckpoint;
+}
+
+void ConnectionConfig::updateTuningPragmas()
+{
+    static const char* const journalModes[] = {
+        "", "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"
+    };
+    static const char* const synchronousModes[] = {
+        "", "OFF", "NORMAL", "FULL", "EXTRA"
+    };
+    static const char* const tempStores[] = {
+        "", "DEFAULT", "FILE", "MEMORY"
+    };
+
+    std::vector<std::string> pragmas;
+
+    // page size is applied first (it is used by the new database file only)
+    if (_pageSize != notSet) {
+        pragmas.push_back(std::string("PRAGMA page_size = ")
+                          + std::to_string(_pageSize));
+    }
+    if (_journalMode != JournalMode::NotSet) {
+        pragmas.push_back(std::string("PRAGMA journal_mode = ")
+                          + journalModes[static_cast<int>(_journalMode)]);
+    }
+    if (_synchronous != Synchronous::NotSet) {
+        pragmas.push_back(std::string("PRAGMA synchronous = ")
+                          + synchronousModes[static_cast<int>(_synchronous)]);
+    }
+    if (_cacheSize != notSet) {
+        pragmas.push_back(std::string("PRAGMA cache_size = ")
+                          + std::to_string(_cacheSize));
+    }
+    if (_mmapSize != notSet) {
+        pragmas.push_back(std::string("PRAGMA mmap_size = ")
+                          + std::to_string(_mmapSize));
+    }
+    if (_tempStore != TempStore::NotSet) {
+        pragmas.push_back(std::string("PRAGMA temp_store = ")
+                          + tempStores[static_cast<int>(_tempStore)]);
+    }
+    if (_walAutocheckpoint != notSet) {
+        pragmas.push_back(std::string("PRAGMA wal_autocheckpoint = ")
+                          + std::to_string(_walAutocheckpoint));
+    }
+
+    _tuningPragmas = std::move(pragmas);
+}
@@ -1,27 +1,54 @@
 #include "../include/connection_creator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
 #include "../include/create_conn_exception.h"
 
-using Container = std::unordered_map<std::string, ConnectionConfig>;
+using Config = std::shared_ptr<const ConnectionConfig>;
+using Container = std::unordered_map<std::string, Config>;
+using Pools = std::unordered_map<std::string, std::shared_ptr<ConnectionPool>>;
 using LockGuard = std::lock_guard<std::mutex>;
 
 
+// readers of configs check version only, it must not take a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Version of configs snapshot must be lock-free");
+
+constexpr size_t ConnectionCreator::maxCachedConfigs;
+
+std::atomic<uint64_t> ConnectionCreator::_lastVersion(0);
+
+ConnectionCreator::ConnectionCreator()
+    : _version(_lastVersion.fetch_add(1) + 1),
+      _configurations(std::make_shared<const Container>()),
+      _schemaVersions(std::make_shared<SchemaVersions>())
+{}
+
 ConnectionCreator::ConnectionCreator(const ConnectionCreator& conn)
+    : _version(_lastVersion.fetch_add(1) + 1)
 {
     // lock mutex
     LockGuard lock(conn._mutex);
 
-    // copy content
+    // share content (snapshot is not changed, it is replaced)
     _configurations = conn._configurations;
+    _schemaVersions = conn._schemaVersions;
 }
 
 ConnectionCreator::ConnectionCreator(ConnectionCreator&& conn)
+    : _version(_lastVersion.fetch_add(1) + 1)
 {
     // lock mutex
     LockGuard lock(conn._mutex);
 
-    // move content
-    _configurations = std::move(conn._configurations);
+    // move content (moved object publishes empty snapshot)
+    _configurations = conn._configurations;
+    _schemaVersions = conn._schemaVersions;
+    _pools = std::move(conn._pools);
+    conn.publishConfigs(std::make_shared<Container>());
 }
 
 ConnectionCreator::~ConnectionCreator() noexcept
@@ -30,19 +57,41 @@ ConnectionCreator::~ConnectionCreator() noexcept
         // lock mutex
         LockGuard lock(_mutex);
 
-        // clear saved configs
-        _configurations.clear();
+        // clear saved pools (configs are released with the last snapshot)
+        _pools.clear();
     } catch (...) {}
 }
 
+PooledConnection
+ConnectionCreator::acquireConnection(const std::string& configName) const
+{
+    // try find pool for 'configName' (or throw if not exists)
+    std::shared_ptr<ConnectionPool> pool = poolByName(configName);
+    if (!pool) {
+        std::string errorMsg("Error: pool for \'");
+        throw CreateConnException(errorMsg.append(configName)
+                                  .append("\' configuration not found!"));
+    }
+
+    // take free connection from the pool (or throw on timeout)
+    return pool->acquire();
+}
+
 bool ConnectionCreator::addConfig(const ConnectionConfig& value,
                                   const std::string&      name)
 {
     // lock mutex
     LockGuard lock(_mutex);
 
-    // try insert new config and return result
-    return _configurations.emplace(name, value).second;
+    // try insert new config to copy of snapshot and publish it
+    std::shared_ptr<Container> configs = copyConfigs();
+    if (!configs->emplace(name, std::make_shared<const ConnectionConfig>
+                          (value)).second) {
+        return false;
+    }
+    publishConfigs(std::move(configs));
+
+    return true;
 }
 
 void ConnectionCreator::addOrReplaceConfig(const ConnectionConfig& value,
@@ -51,8 +100,11 @@ void ConnectionCreator::addOrReplaceConfig(const ConnectionConfig& value,
     // lock mutex
     LockGuard lock(_mutex);
 
-    // insert new (or replace existing) config
-    _configurations[name] = value;
+    // insert new (or replace existing) config and drop outdated pool
+    std::shared_ptr<Container> configs = copyConfigs();
+    (*configs)[name] = std::make_shared<const ConnectionConfig>(value);
+    publishConfigs(std::move(configs));
+    _pools.erase(name);
 }
 
 void ConnectionCreator::clearConfigs()
@@ -60,22 +112,22 @@ void ConnectionCreator::clearConfigs()
     // lock mutex
     LockGuard lock(_mutex);
 
-    // clear saved configs
-    _configurations.clear();
+    // publish empty snapshot and clear saved pools
+    publishConfigs(std::make_shared<Container>());
+    _pools.clear();
 }
 
 std::vector<std::string> ConnectionCreator::configsArray() const
 {
-    // lock mutex
-    LockGuard lock(_mutex);
+    // take current snapshot
+    const std::shared_ptr<const Container> configs = configsSnapshot();
 
     // reserve memory for array
     std::vector<std::string> result;
-    result.reserve(_configurations.size());
+    result.reserve(configs->size());
 
     // read and save all configs names
-    for (auto it = _configurations.cbegin();
-         it != _configurations.cend(); ++it) {
+    for (auto it = configs->cbegin(); it != configs->cend(); ++it) {
         result.push_back(it->first);
     }
 
@@ -88,27 +140,63 @@ ConnectionCreator::configByName(const std::string& name) const noexcept
 {
     std::pair<ConnectionConfig, bool> result;    // default result
 
-    // lock mutex
-    LockGuard lock(_mutex);
-
     // try find config with name 'name' (and assign to result, if any)
-    Container::const_iterator it = _configurations.find(name);
-    result.second = (it != _configurations.cend());
+    const Config config = configSnapshot(name);
+    result.second = static_cast<bool>(config);
     if (result.second) {
-        result.first = it->second;
+        result.first = *config;
     }
 
     // return found (or default) config with bool flag
     return result;
 }
 
+std::shared_ptr<const ConnectionConfig>
+ConnectionCreator::configSnapshot(const std::string& name) const noexcept
+{
+    // snapshot is read without lock and config is not copied
+    const std::shared_ptr<const Container> configs = configsSnapshot();
+
+    Container::const_iterator it = configs->find(name);
+    return (it != configs->cend()) ? it->second : Config();
+}
+
 int ConnectionCreator::configsCount() const noexcept
 {
+    // return number of saved configurations
+    return configsSnapshot()->size();
+}
+
+bool ConnectionCreator::createPool(const std::string&              configName,
+                                   const int                       minSize,
+                                   const int                       maxSize,
+                                   const std::chrono::milliseconds
+                                       acquireTimeout)
+{
+    // try find config with 'configName'
+    const Config config = configSnapshot(configName);
+    if (!config) {
+        return false;
+    }
+
+    // create pool (minimal number of connections is opened here)
+    const std::shared_ptr<SchemaVersions> versions = _schemaVersions;
+    std::shared_ptr<ConnectionPool> pool = ConnectionPool::create(
+                [config, versions] () -> Connection {
+                    return openConnection(*config, *versions);
+                },
+                minSize, maxSize, acquireTimeout);
+
     // lock mutex
     LockGuard lock(_mutex);
 
-    // return number of saved configurations
-    return _configurations.size();
+    // save pool, if config was not replaced in the meantime
+    if (configSnapshot(configName) != config) {
+        return false;
+    }
+
+    _pools[configName] = std::move(pool);
+    return true;
 }
 
 bool ConnectionCreator::deleteConfig(const std::string& name)
@@ -116,51 +204,180 @@ bool ConnectionCreator::deleteConfig(const std::string& name)
     // lock mutex
     LockGuard lock(_mutex);
 
-    return _configurations.erase(name) > 0;
+    _pools.erase(name);
+
+    // try remove config from copy of snapshot and publish it
+    std::shared_ptr<Container> configs = copyConfigs();
+    if (!configs->erase(name)) {
+        return false;
+    }
+    publishConfigs(std::move(configs));
+
+    return true;
 }
 
-bool ConnectionCreator::isConfigExists(const std::string& name) const noexcept
+bool ConnectionCreator::deletePool(const std::string& configName)
 {
     // lock mutex
     LockGuard lock(_mutex);
 
+    // connections in use will be closed by their leases
+    return _pools.erase(configName) > 0;
+}
+
+bool ConnectionCreator::isConfigExists(const std::string& name) const noexcept
+{
     // check if config exist and return result
-    return _configurations.find(name) != _configurations.cend();
+    return static_cast<bool>(configSnapshot(name));
 }
 
 Connection ConnectionCreator::newConnection(const std::string& configName) const
 {
     // try find config with 'configName' (or throw if not exists)
-    std::pair<ConnectionConfig, bool> conf = configByName(configName);
-    if (!conf.second) {
+    const Config config = configSnapshot(configName);
+    if (!config) {
         std::string errorMsg("Error: \'");
         throw CreateConnException(errorMsg.append(configName)
                                   .append("\' configuration not found!"));
     }
 
-    std::string openErrorMsg;   // for error message in exception object
+    // open and configure connection (or throw on error)
+    return openConnection(*config, *_schemaVersions);
+}
 
-    Connection result(conf.first.databaseName(), conf.first.openMode(),
-                      conf.first.cacheMode());
+std::shared_ptr<WalConnectionGroup>
+ConnectionCreator::newWalGroup(const std::string&              configName,
+                               const int                       readers,
+                               const std::chrono::milliseconds
+                                   acquireTimeout) const
+{
+    // try find config with 'configName' (or throw if not exists)
+    const Config conf = configSnapshot(configName);
+    if (!conf) {
+        std::string errorMsg("Error: \'");
+        throw CreateConnException(errorMsg.append(configName)
+                                  .append("\' configuration not found!"));
+    }
 
-    // try open connection and throw on error
-    if (!result.open()) {
-        openErrorMsg = "Error opening database: ";
-    // try create database schema
-    } else if (!createSchema(result, conf.first.createSchemaScript())) {
-        openErrorMsg = "Error creating database schema: ";
-    // try configure connection
-    } else if (!configureConnection(result,
-                                    conf.first.configConnectionScript())) {
-        openErrorMsg = "Error during connection configuration: ";
+    // readers and writer have to share writable database file
+    const Connection::OpenMode mode = conf->openMode();
+    if (mode != Connection::OpenMode::ReadWriteCreate
+            && mode != Connection::OpenMode::ReadWrite) {
+        throw CreateConnException("Error: WAL group needs writable "
+                                  "database file!");
     }
 
-    // throw if error occured (connection will close automatically)
-    if (!openErrorMsg.empty()) {
-        throw CreateConnException(openErrorMsg.append(result.lastError()));
+    // open writer (it creates schema) and switch database to WAL mode
+    Connection writer = openConnection(*conf, *_schemaVersions);
+    if (!enableWal(writer)) {
+        std::string errorMsg("Error enabling WAL mode: ");
+        throw CreateConnException(errorMsg.append(writer.lastError()));
+    }
+
+    // open read-only connections
+    ConnectionConfig config(*conf);
+    config.setOpenMode(Connection::OpenMode::ReadOnly);
+    config.setCreateSchemaScript(std::string());
+    config.clearMigrations();
+    const std::shared_ptr<SchemaVersions> versions = _schemaVersions;
+    std::shared_ptr<ConnectionPool> pool = ConnectionPool::create(
+                [config, versions] () -> Connection {
+                    return openConnection(config, *versions);
+                },
+                readers, readers, acquireTimeout);
+
+    // read-only connection classifies statements, so writes never wait
+    // for pooled readers
+    Connection classifier = openConnection(config, *_schemaVersions);
+
+    return std::make_shared<WalConnectionGroup>(std::move(writer),
+                                                std::move(classifier),
+                                                std::move(pool));
+}
+
+std::pair<ConnectionPool::Stats, bool>
+ConnectionCreator::poolStats(const std::string& configName) const noexcept
+{
+    std::pair<ConnectionPool::Stats, bool> result;   // default result
+
+    // try find pool and read its statistics
+    std::shared_ptr<ConnectionPool> pool = poolByName(configName);
+    result.second = static_cast<bool>(pool);
+    if (result.second) {
+        result.first = pool->stats();
+    }
+
+    return result;
+}
+
+std::vector<Connection>
+ConnectionCreator::prewarm(const std::string& configName,
+                           const int          count,
+                           const int          threads) const
+{
+    // try find config with 'configName' (or throw if not exists)
+    const Config config = configSnapshot(configName);
+    if (!config) {
+        std::string errorMsg("Error: \'");
+        throw CreateConnException(errorMsg.append(configName)
+                                  .append("\' configuration not found!"));
+    }
+
+    std::vector<Connection> result(std::max(count, 0));
+    if (result.empty()) {
+        return result;
+    }
+
+    // use thread per core, if number of threads is not set (single-thread
+    // sqlite3 has no mutexes, so connections are opened one by one then)
+    int threadCount = threads > 0
+            ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, count));
+    if (Connection::defaultThreadMode()
+            == Connection::ThreadMode::SingleThread) {
+        threadCount = 1;
+    }
+
+    // threads take indexes of connections one by one and save first error
+    std::atomic_int next(0);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    SchemaVersions& versions = *_schemaVersions;
+
+    auto openNext = [&] () {
+        for (int i = next++; i < count; i = next++) {
+            try {
+                result[i] = openConnection(*config, versions);
+            } catch (...) {
+                LockGuard lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; ++i) {
+        try {
+            workers.emplace_back(openNext);
+        } catch (...) {
+            // the rest of connections is opened by started threads
+            break;
+        }
+    }
+    openNext();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // opened connections are closed, if any of them failed
+    if (error) {
+        std::rethrow_exception(error);
     }
 
-    // return created object
     return result;
 }
 
@@ -170,28 +387,227 @@ bool ConnectionCreator::replaceConfig(const std::string&      name,
     // lock mutex
     LockGuard guard(_mutex);
 
-    // try replace config and return result
-    Container::iterator it = _configurations.find(name);
-    if (it != _configurations.end()) {
-        it->second = newValue;
+    // try replace config in copy of snapshot and publish it
+    std::shared_ptr<Container> configs = copyConfigs();
+    Container::iterator it = configs->find(name);
+    if (it != configs->end()) {
+        it->second = std::make_shared<const ConnectionConfig>(newValue);
+        publishConfigs(std::move(configs));
+        _pools.erase(name);
         return true;
     } else {
         return false;
     }
 }
 
-bool
-ConnectionCreator::configureConnection(Connection&        connection,
-                                       const std::string& script) const noexcept
+std::shared_ptr<ConnectionPool>
+ConnectionCreator::poolByName(const std::string& configName) const noexcept
+{
+    // lock mutex
+    LockGuard lock(_mutex);
+
+    // try find pool with name 'configName'
+    Pools::const_iterator it = _pools.find(configName);
+    return (it != _pools.cend()) ? it->second
+                                 : std::shared_ptr<ConnectionPool>();
+}
+
+std::shared_ptr<const Container>
+ConnectionCreator::configsSnapshot() const noexcept
+{
+    thread_local std::unordered_map<const ConnectionCreator*,
+                                    CachedConfigs> cache;
+
+    // fast path: snapshot of the thread is not changed since last time
+    const uint64_t version = _version.load(std::memory_order_acquire);
+    auto cached = cache.find(this);
+    if (cached != cache.end() && cached->second.version == version) {
+        return cached->second.configs;
+    }
+
+    // take published snapshot with its version
+    std::shared_ptr<const Container> configs;
+    uint64_t configsVersion;
+    {
+        LockGuard lock(_snapshotMutex);
+        configs = _configurations;
+        configsVersion = _version.load(std::memory_order_relaxed);
+    }
+
+    // remember snapshot (caches of destroyed creators are dropped from
+    // time to time, they keep old snapshots only)
+    try {
+        if (cached == cache.end() && cache.size() >= maxCachedConfigs) {
+            cache.clear();
+        }
+        CachedConfigs& value = cache[this];
+        value.version = configsVersion;
+        value.configs = configs;
+    } catch (...) {}
+
+    return configs;
+}
+
+std::shared_ptr<Container> ConnectionCreator::copyConfigs() const
+{
+    // configs are shared by snapshots, so only pointers are copied (it is
+    // called by writer, so snapshot is not changed in the meantime)
+    return std::make_shared<Container>(*_configurations);
+}
+
+void ConnectionCreator::publishConfigs(std::shared_ptr<Container>&& configs)
+noexcept
+{
+    // readers keep old snapshot, until they release it
+    LockGuard lock(_snapshotMutex);
+    _configurations = std::move(configs);
+    _version.store(_lastVersion.fetch_add(1) + 1, std::memory_order_release);
+}
+
+bool ConnectionCreator::configureConnection(Connection&        connection,
+                                            const std::string& script) noexcept
 {
     return script.empty() || connection.execute(script);
 }
 
 bool ConnectionCreator::createSchema(Connection&        connection,
-                                     const std::string& script) const noexcept
+                                     const std::string& script) noexcept
 {
     // create db schema, if not exists
     return script.empty()
             || connection.readInt64("select count(*) from sqlite_master")
             || connection.execute(script);
 }
+
+bool ConnectionCreator::enableWal(Connection& connection)
+{
+    // journal mode is persistent, so readers open database in WAL mode too
+    if (!connection.execute("PRAGMA journal_mode = WAL")) {
+        return false;
+    }
+
+    // check mode (it is not changed for some databases)
+    int code;
+    const std::string mode = connection.read<std::string>(
+                "SELECT journal_mode FROM pragma_journal_mode", &code);
+
+    return code == Connection::ReadSuccess && mode == "wal";
+}
+
+bool ConnectionCreator::migrate(Connection&             connection,
+                                const ConnectionConfig& config)
+{
+    static const std::string versionQuery("SELECT user_version "
+                                          "FROM pragma_user_version");
+
+    // empty database is created by script (old way of schema creation)
+    int code;
+    int version = connection.read<int>(versionQuery, &code);
+    if (code != Connection::ReadSuccess) {
+        return false;
+    } else if (!version
+               && !createSchema(connection, config.createSchemaScript())) {
+        return false;
+    }
+
+    // each step is executed in own transaction, version is checked again
+    // within it, because another process can migrate database too
+    for (const std::pair<const int, std::string>& step
+         : config.migrations()) {
+        if (step.first <= version) {
+            continue;
+        }
+
+        if (!connection.execute("BEGIN IMMEDIATE")) {
+            return false;
+        }
+        version = connection.read<int>(versionQuery, &code);
+        // transaction of failed step is rolled back, when connection is
+        // closed on error (so error message is kept for exception)
+        if (code != Connection::ReadSuccess
+                || (step.first > version
+                    && (!connection.execute(step.second)
+                        || !connection.execute(
+                            "PRAGMA user_version = "
+                            + std::to_string(step.first))))
+                || !connection.commit()) {
+            return false;
+        }
+        version = std::max(version, step.first);
+    }
+
+    return true;
+}
+
+bool ConnectionCreator::migrateOnce(Connection&             connection,
+                                    const ConnectionConfig& config,
+                                    SchemaVersions&         schemaVersions)
+{
+    // read-only database can not be changed
+    const Connection::OpenMode mode = config.openMode();
+    if (mode == Connection::OpenMode::ReadOnly) {
+        return true;
+    }
+
+    // temporary and in-memory databases are new on each open
+    if (config.databaseName().empty()
+            || (mode != Connection::OpenMode::ReadWriteCreate
+                && mode != Connection::OpenMode::ReadWrite)) {
+        return migrate(connection, config);
+    }
+
+    // file database is migrated once by this creator (it is not checked
+    // again, if file is replaced by another process), creator-wide lock is
+    // held only to find the file, so different files are migrated at once
+    SchemaVersion* version;
+    {
+        LockGuard lock(schemaVersions.mutex);
+        version = &schemaVersions.versions[config.databaseName()];
+    }
+
+    LockGuard lock(version->mutex);
+    if (version->isMigrated && version->version >= config.schemaVersion()) {
+        return true;
+    }
+
+    if (!migrate(connection, config)) {
+        return false;
+    }
+    version->version = config.schemaVersion();
+    version->isMigrated = true;
+
+    return true;
+}
+
+Connection
+ConnectionCreator::openConnection(const ConnectionConfig& config,
+                                  SchemaVersions&         schemaVersions)
+{
+    std::string openErrorMsg;   // for error message in exception object
+
+    Connection result(config.databaseName(), config.openMode(),
+                      config.cacheMode());
+
+    // try open connection and throw on error
+    if (!result.open()) {
+        openErrorMsg = "Error opening database: ";
+    // try apply typed settings (page size is used by new database file)
+    } else if (!config.tune(result)) {
+        openErrorMsg = "Error during connection tuning: ";
+    // try create or upgrade database schema
+    } else if (!migrateOnce(result, config, schemaVersions)) {
+        openErrorMsg = "Error creating database schema: ";
+    // try configure connection
+    } else if (!configureConnection(result,
+                                    config.configConnectionScript())) {
+        openErrorMsg = "Error during connection configuration: ";
+    }
+
+    // throw if error occured (connection will close automatically)
+    if (!openErrorMsg.empty()) {
+        throw CreateConnException(openErrorMsg.append(result.lastError()));
+    }
+
+    // return created object
+    return result;
+}
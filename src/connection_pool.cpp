@@ -0,0 +1,249 @@
+#include "../include/connection_pool.h"
+
+#include <algorithm>
+#include <string>
+
+#include "../include/create_conn_exception.h"
+
+using LockGuard = std::lock_guard<std::mutex>;
+using UniqueLock = std::unique_lock<std::mutex>;
+
+
+constexpr std::chrono::milliseconds ConnectionPool::defaultAcquireTimeout;
+
+PooledConnection::PooledConnection() noexcept
+{}
+
+PooledConnection::PooledConnection(PooledConnection&& lease) noexcept
+    : _pool(std::move(lease._pool)),
+      _connection(std::move(lease._connection))
+{}
+
+PooledConnection::PooledConnection(std::shared_ptr<ConnectionPool>&& pool,
+                                   Connection&& connection) noexcept
+    : _pool(std::move(pool)),
+      _connection(std::move(connection))
+{}
+
+PooledConnection::~PooledConnection() noexcept
+{
+    release();
+}
+
+Connection& PooledConnection::connection() noexcept
+{
+    return _connection;
+}
+
+bool PooledConnection::isValid() const noexcept
+{
+    return static_cast<bool>(_pool);
+}
+
+void PooledConnection::release() noexcept
+{
+    // return connection to the pool (if lease is valid)
+    if (_pool) {
+        _pool->giveBack(std::move(_connection));
+        _pool.reset();
+    }
+}
+
+PooledConnection& PooledConnection::operator=(PooledConnection&& lease) noexcept
+{
+    if (this != &lease) {
+        release();
+
+        _pool = std::move(lease._pool);
+        _connection = std::move(lease._connection);
+    }
+
+    return *this;
+}
+
+Connection* PooledConnection::operator->() noexcept
+{
+    return &_connection;
+}
+
+Connection& PooledConnection::operator*() noexcept
+{
+    return _connection;
+}
+
+ConnectionPool::ConnectionPool(Factory&&                       factory,
+                               const int                       minSize,
+                               const int                       maxSize,
+                               const std::chrono::milliseconds acquireTimeout)
+    : _factory(std::move(factory)),
+      _minSize(std::max(minSize, 0)),
+      _maxSize(std::max(maxSize, std::max(minSize, 1))),
+      _acquireTimeout(acquireTimeout),
+      _inUse(0),
+      _opening(0),
+      _stats()
+{
+    _idle.reserve(_maxSize);
+}
+
+PooledConnection ConnectionPool::acquire()
+{
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + _acquireTimeout;
+    bool saturated = false;
+
+    UniqueLock lock(_mutex);
+
+    while (true) {
+        // reuse most recently returned connection (if any)
+        if (!_idle.empty()) {
+            Connection result(std::move(_idle.back()));
+            _idle.pop_back();
+            ++_inUse;
+            recordAcquire(start);
+            return PooledConnection(shared_from_this(), std::move(result));
+        }
+
+        // open new connection, if pool is not full
+        if (_inUse + _opening < _maxSize) {
+            ++_opening;
+            lock.unlock();
+
+            Connection result;
+            try {
+                result = _factory();
+            } catch (...) {
+                lock.lock();
+                --_opening;
+                _released.notify_one();
+                throw;
+            }
+
+            lock.lock();
+            --_opening;
+            ++_inUse;
+            recordAcquire(start);
+            return PooledConnection(shared_from_this(), std::move(result));
+        }
+
+        // all connections are in use, wait for released one
+        if (!saturated) {
+            saturated = true;
+            ++_stats.saturated;
+        }
+
+        if (_released.wait_until(lock, deadline) == std::cv_status::timeout
+                && _idle.empty() && _inUse + _opening >= _maxSize) {
+            ++_stats.timeouts;
+            throw CreateConnException("Error: timeout while waiting for "
+                                      "a free connection in pool!");
+        }
+    }
+}
+
+std::chrono::milliseconds ConnectionPool::acquireTimeout() const noexcept
+{
+    return _acquireTimeout;
+}
+
+int ConnectionPool::idleCount() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return _idle.size();
+}
+
+int ConnectionPool::inUseCount() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return _inUse;
+}
+
+int ConnectionPool::maxSize() const noexcept
+{
+    return _maxSize;
+}
+
+int ConnectionPool::minSize() const noexcept
+{
+    return _minSize;
+}
+
+void ConnectionPool::resetStats() noexcept
+{
+    LockGuard lock(_mutex);
+
+    _stats = Stats();
+    _stats.peakInUse = _inUse;
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    // fill current state of the pool and return copy of counters
+    Stats result = _stats;
+    result.idle = _idle.size();
+    result.inUse = _inUse;
+    result.maxSize = _maxSize;
+
+    return result;
+}
+
+std::shared_ptr<ConnectionPool>
+ConnectionPool::create(Factory&&                       factory,
+                       const int                       minSize,
+                       const int                       maxSize,
+                       const std::chrono::milliseconds acquireTimeout)
+{
+    std::shared_ptr<ConnectionPool> result(
+                new ConnectionPool(std::move(factory), minSize,
+                                   maxSize, acquireTimeout));
+
+    // open minimal number of connections (throws on error)
+    result->fill();
+
+    return result;
+}
+
+void ConnectionPool::fill()
+{
+    while (static_cast<int>(_idle.size()) < _minSize) {
+        Connection connection = _factory();
+
+        LockGuard lock(_mutex);
+        _idle.push_back(std::move(connection));
+    }
+}
+
+void ConnectionPool::giveBack(Connection connection) noexcept
+{
+    // finish transaction, that was left open by the lease owner
+    if (connection.inTransaction()) {
+        connection.rollback();
+    }
+
+    LockGuard lock(_mutex);
+
+    // keep only usable connections
+    if (connection.isOpen() && !connection.inTransaction()) {
+        try {
+            _idle.push_back(std::move(connection));
+        } catch (...) {}
+    }
+
+    --_inUse;
+    _released.notify_one();
+}
+
+void ConnectionPool::recordAcquire(const Clock::time_point& start) noexcept
+{
+    const uint64_t waitMicros = std::chrono::duration_cast
+            <std::chrono::microseconds>(Clock::now() - start).count();
+
+    ++_stats.acquired;
+    _stats.totalWaitMicros += waitMicros;
+    _stats.maxWaitMicros = std::max(_stats.maxWaitMicros, waitMicros);
+    _stats.peakInUse = std::max(_stats.peakInUse, _inUse);
+}
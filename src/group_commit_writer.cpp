@@ -0,0 +1,299 @@
+#include "../include/group_commit_writer.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using LockGuard = std::lock_guard<std::mutex>;
+using UniqueLock = std::unique_lock<std::mutex>;
+
+
+constexpr int GroupCommitWriter::defaultMaxBatchSize;
+constexpr std::chrono::microseconds GroupCommitWriter::defaultMaxDelay;
+constexpr int GroupCommitWriter::noWakeUp;
+
+GroupCommitWriter::GroupCommitWriter(
+        Connection&&                    connection,
+        const int                       maxBatchSize,
+        const std::chrono::microseconds maxDelay)
+    : _head(nullptr),
+      _queued(0),
+      _wakeUpQueued(noWakeUp),
+      _submitting(0),
+      _stopping(false),
+      _batches(0),
+      _writes(0),
+      _failedWrites(0),
+      _failedCommits(0),
+      _maxBatchSize(std::max(maxBatchSize, 1)),
+      _maxDelay(std::max(maxDelay, std::chrono::microseconds(0))),
+      _connection(std::move(connection))
+{
+    // start worker thread, that owns the connection from now
+    _worker = std::thread(&GroupCommitWriter::run, this);
+}
+
+GroupCommitWriter::~GroupCommitWriter() noexcept
+{
+    stop();
+
+    // complete writes, that were pushed while worker was finishing
+    Node* node = takeAll();
+    while (node) {
+        Node* const next = node->next;
+        complete(node, false);
+        node = next;
+    }
+}
+
+std::future<bool> GroupCommitWriter::execute(const std::string& query)
+{
+    // execute query (or queries) within batch transaction
+    return submit([query] (Connection& connection) -> bool {
+        return connection.execute(query);
+    });
+}
+
+bool GroupCommitWriter::isRunning() const noexcept
+{
+    return !_stopping.load(std::memory_order_acquire);
+}
+
+int GroupCommitWriter::maxBatchSize() const noexcept
+{
+    return _maxBatchSize;
+}
+
+std::chrono::microseconds GroupCommitWriter::maxDelay() const noexcept
+{
+    return _maxDelay;
+}
+
+GroupCommitWriter::Stats GroupCommitWriter::stats() const noexcept
+{
+    Stats result;
+    result.batches = _batches.load(std::memory_order_relaxed);
+    result.writes = _writes.load(std::memory_order_relaxed);
+    result.failedWrites = _failedWrites.load(std::memory_order_relaxed);
+    result.failedCommits = _failedCommits.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+void GroupCommitWriter::stop() noexcept
+{
+    // stop accepting writes and wake up worker
+    {
+        LockGuard lock(_mutex);
+        _stopping.store(true);
+    }
+    _wakeUp.notify_one();
+
+    // wait until queued writes are committed
+    if (_worker.joinable() && _worker.get_id() != std::this_thread::get_id()) {
+        _worker.join();
+    }
+}
+
+std::future<bool> GroupCommitWriter::submit(Write&& write)
+{
+    // worker does not exit, until producers, that passed the check of
+    // stop, push their writes
+    _submitting.fetch_add(1);
+
+    // return invalid future, if write is not accepted
+    if (_stopping.load()) {
+        _submitting.fetch_sub(1);
+        return std::future<bool>();
+    }
+
+    std::future<bool> result;
+    try {
+        Node* const node = new Node { std::move(write), std::promise<bool>(),
+                                      nullptr };
+        result = node->result.get_future();
+        push(node);
+    } catch (...) {
+        _submitting.fetch_sub(1);
+        throw;
+    }
+    _submitting.fetch_sub(1);
+
+    return result;
+}
+
+void GroupCommitWriter::commitBatch(Node* const batch[],
+                                    const int   size) noexcept
+{
+    _batches.fetch_add(1, std::memory_order_relaxed);
+    _writes.fetch_add(size, std::memory_order_relaxed);
+
+    // all writes fail, if transaction is not started
+    if (!_begin.isValid() || !_begin.execute()) {
+        _failedCommits.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < size; ++i) {
+            complete(batch[i], false);
+        }
+        return;
+    }
+
+    // failed write is rolled back to its savepoint, others are kept
+    std::vector<char> results(size, 0);
+    std::vector<std::exception_ptr> errors(size);
+    for (int i = 0; i < size; ++i) {
+        if (!_savepoint.execute()) {
+            continue;
+        }
+
+        bool result = false;
+        try {
+            result = batch[i]->write(_connection);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+
+        if (result && _release.execute()) {
+            results[i] = 1;
+        } else {
+            _rollbackTo.execute();
+            _release.execute();
+            _failedWrites.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // one commit (and one sync) for the whole batch
+    const bool committed = _commit.execute();
+    if (!committed) {
+        _rollback.execute();
+        _failedCommits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < size; ++i) {
+        if (errors[i]) {
+            batch[i]->result.set_exception(errors[i]);
+            delete batch[i];
+        } else {
+            complete(batch[i], committed && results[i]);
+        }
+    }
+}
+
+void GroupCommitWriter::push(Node* const node) noexcept
+{
+    // lock-free push of producer
+    node->next = _head.load(std::memory_order_relaxed);
+    while (!_head.compare_exchange_weak(node->next, node)) {}
+
+    // wake up worker, if it waits for this count of writes (mutex makes
+    // sure, that it checks the count before waiting or gets notification)
+    if (_queued.fetch_add(1) + 1 >= _wakeUpQueued.load()) {
+        { LockGuard lock(_mutex); }
+        _wakeUp.notify_one();
+    }
+}
+
+void GroupCommitWriter::run() noexcept
+{
+    _begin = _connection.prepare("BEGIN IMMEDIATE");
+    _commit = _connection.prepare("COMMIT");
+    _rollback = _connection.prepare("ROLLBACK");
+    _savepoint = _connection.prepare("SAVEPOINT groupWrite");
+    _release = _connection.prepare("RELEASE groupWrite");
+    _rollbackTo = _connection.prepare("ROLLBACK TO groupWrite");
+
+    std::deque<Node*> pending;
+    std::vector<Node*> batch;
+    batch.reserve(_maxBatchSize);
+
+    // take all pushed writes in order of pushing
+    auto takePushed = [this, &pending] () {
+        for (Node* node = takeAll(); node; node = node->next) {
+            pending.push_back(node);
+        }
+    };
+    auto hasWrites = [this] () {
+        return _queued.load() >= _wakeUpQueued.load() || _stopping.load();
+    };
+
+    while (true) {
+        // sleep until first write is pushed (queue is drained before stop)
+        takePushed();
+        if (pending.empty()) {
+            if (_stopping.load()) {
+                // wait for producers, that passed the check before stop
+                if (!_submitting.load() && !_head.load()) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            _wakeUpQueued.store(1);
+            {
+                UniqueLock lock(_mutex);
+                _wakeUp.wait(lock, hasWrites);
+            }
+            _wakeUpQueued.store(noWakeUp);
+            continue;
+        }
+
+        // wait for writes of other threads until deadline, producers wake
+        // worker up only, when batch is full
+        const int missing = _maxBatchSize - static_cast<int>(pending.size());
+        if (missing > 0 && !_stopping.load()) {
+            const Clock::time_point deadline = Clock::now() + _maxDelay;
+            _wakeUpQueued.store(missing);
+            {
+                UniqueLock lock(_mutex);
+                _wakeUp.wait_until(lock, deadline, hasWrites);
+            }
+            _wakeUpQueued.store(noWakeUp);
+            takePushed();
+        }
+
+        // commit batch (the rest of writes goes to the next one)
+        while (!pending.empty()
+               && static_cast<int>(batch.size()) < _maxBatchSize) {
+            batch.push_back(pending.front());
+            pending.pop_front();
+        }
+        commitBatch(batch.data(), batch.size());
+        batch.clear();
+    }
+
+    // close connection within the thread, that used it
+    _begin.clear();
+    _commit.clear();
+    _rollback.clear();
+    _savepoint.clear();
+    _release.clear();
+    _rollbackTo.clear();
+    _connection.close();
+}
+
+GroupCommitWriter::Node* GroupCommitWriter::takeAll() noexcept
+{
+    // take stack of pushed nodes and reverse it
+    Node* node = _head.exchange(nullptr);
+    Node* result = nullptr;
+    int count = 0;
+    while (node) {
+        Node* const next = node->next;
+        node->next = result;
+        result = node;
+        node = next;
+        ++count;
+    }
+    _queued.fetch_sub(count);
+
+    return result;
+}
+
+void GroupCommitWriter::complete(Node* const node,
+                                 const bool  result) noexcept
+{
+    node->result.set_value(result);
+    delete node;
+}
@@ -0,0 +1,205 @@
+#include "../include/memory_replica.h"
+
+#include <algorithm>
+
+#include "../include/sqlite3.h"
+
+using Clock = std::chrono::steady_clock;
+using LockGuard = std::lock_guard<std::mutex>;
+using UniqueLock = std::unique_lock<std::mutex>;
+
+
+constexpr std::chrono::milliseconds MemoryReplica::minLockedDelay;
+constexpr std::chrono::milliseconds MemoryReplica::maxLockedDelay;
+
+MemoryReplica::MemoryReplica(const std::string& name,
+                             const std::string& fileName)
+    : _name(name),
+      _fileName(fileName),
+      _keeper(name, Connection::OpenMode::InMemory,
+              Connection::CacheMode::Shared),
+      _syncCount(0),
+      _stopping(false)
+{}
+
+MemoryReplica::~MemoryReplica() noexcept
+{
+    stopSync();
+}
+
+Connection MemoryReplica::connect() const
+{
+    Connection result(_name, Connection::OpenMode::InMemory,
+                      Connection::CacheMode::Shared);
+
+    // tables are locked by replica for whole refresh, so reader waits
+    // for unlock notification instead of failing with SQLITE_LOCKED
+    std::shared_ptr<BusyHandler> handler = std::make_shared<BusyHandler>();
+    handler->setUnlockNotify(true);
+    result.setBusyHandler(handler);
+    result.open();
+
+    return result;
+}
+
+std::string MemoryReplica::fileName() const
+{
+    return _fileName;
+}
+
+bool MemoryReplica::isLoaded() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return _keeper.isOpen();
+}
+
+std::string MemoryReplica::lastError() const
+{
+    LockGuard lock(_mutex);
+
+    return _lastError;
+}
+
+bool MemoryReplica::load()
+{
+    LockGuard lock(_mutex);
+
+    // open in-memory database (it lives until the connection is closed)
+    if (!_keeper.isOpen() && !_keeper.open()) {
+        _lastError = _keeper.lastError();
+        return false;
+    }
+
+    return copy(SyncMode::Refresh);
+}
+
+std::string MemoryReplica::name() const
+{
+    return _name;
+}
+
+bool MemoryReplica::persist()
+{
+    LockGuard lock(_mutex);
+
+    return _keeper.isOpen() && copy(SyncMode::Persist);
+}
+
+bool MemoryReplica::refresh()
+{
+    LockGuard lock(_mutex);
+
+    return _keeper.isOpen() && copy(SyncMode::Refresh);
+}
+
+bool MemoryReplica::startSync(const std::chrono::milliseconds interval,
+                              const SyncMode                  mode)
+{
+    LockGuard lock(_mutex);
+
+    // only one sync thread is started (and only for loaded replica)
+    if (_worker.joinable() || !_keeper.isOpen()) {
+        return false;
+    }
+
+    _stopping = false;
+    _worker = std::thread(&MemoryReplica::run, this, interval, mode);
+
+    return true;
+}
+
+void MemoryReplica::stopSync() noexcept
+{
+    {
+        LockGuard lock(_mutex);
+        _stopping = true;
+    }
+    _stopped.notify_all();
+
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+}
+
+int MemoryReplica::syncCount() const noexcept
+{
+    LockGuard lock(_mutex);
+
+    return _syncCount;
+}
+
+bool MemoryReplica::copy(const SyncMode mode)
+{
+    // file is opened for one copy only, so it is not locked between copies
+    Connection file(_fileName, mode == SyncMode::Refresh
+                    ? Connection::OpenMode::ReadOnly
+                    : Connection::OpenMode::ReadWriteCreate);
+    if (!file.open()) {
+        _lastError = file.lastError();
+        return false;
+    }
+
+    const bool isCopied = transfer(file, mode);
+
+    // sqlite3 does not call unlock notification at the end of backup, so
+    // readers waiting for replica are woken by empty statement of keeper
+    _keeper.execute("SELECT 1");
+    if (!isCopied) {
+        return false;
+    }
+
+    ++_syncCount;
+    return true;
+}
+
+void MemoryReplica::run(const std::chrono::milliseconds interval,
+                        const SyncMode                  mode) noexcept
+{
+    UniqueLock lock(_mutex);
+
+    // copy database after every interval, until sync is stopped
+    while (!_stopped.wait_for(lock, interval, [this] () {
+                                  return _stopping;
+                              })) {
+        try {
+            copy(mode);
+        } catch (...) {}
+    }
+}
+
+bool MemoryReplica::transfer(Connection&    file,
+                             const SyncMode mode)
+{
+    // destination is write-locked by sqlite3 until backup is finished, so
+    // replica is refreshed by one step (readers of replica wait for whole
+    // copy anyway), file is persisted by steps to let its readers work
+    Connection& destination = (mode == SyncMode::Refresh) ? _keeper : file;
+    const Clock::time_point deadline = Clock::now()
+            + BusyHandler::defaultTimeout;
+    std::chrono::milliseconds delay(minLockedDelay);
+    for (;;) {
+        Backup backup = (mode == SyncMode::Refresh)
+                ? file.backupTo(_keeper) : _keeper.backupTo(file);
+        if (!backup.isOpen()) {
+            _lastError = destination.lastError();
+            return false;
+        } else if (backup.run(mode == SyncMode::Refresh
+                              ? -1 : Backup::defaultPagesPerStep,
+                              std::chrono::milliseconds(1))) {
+            return true;
+        }
+
+        // backup fails, if replica is read at this moment, so it is started
+        // again after readers are finished
+        if (backup.lastResultCode() != SQLITE_LOCKED_SHAREDCACHE) {
+            _lastError = destination.lastError();
+            return false;
+        } else if (Clock::now() + delay > deadline) {
+            _lastError = sqlite3_errstr(SQLITE_LOCKED_SHAREDCACHE);
+            return false;
+        }
+        std::this_thread::sleep_for(delay);
+        delay = std::min(delay * 2, maxLockedDelay);
+    }
+}
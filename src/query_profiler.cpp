@@ -0,0 +1,299 @@
+#include "../include/query_profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include "../include/sqlite3.h"
+
+using LockGuard = std::lock_guard<std::mutex>;
+
+
+constexpr int QueryProfiler::bucketCount;
+constexpr size_t QueryProfiler::maxShortcuts;
+
+std::atomic<uint64_t> QueryProfiler::_nextId(1);
+
+QueryProfiler::QueryProfiler() noexcept
+    : _id(_nextId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+bool QueryProfiler::attach(sqlite3* const db) noexcept
+{
+    // profile callback is called after every statement is finished
+    return sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE,
+                            &QueryProfiler::trace, this) == SQLITE_OK;
+}
+
+void QueryProfiler::record(const void* const statement,
+                           const char* const query,
+                           const uint64_t    nanos) noexcept
+{
+    Entry* entry;
+    if (!query) {
+        return;
+    }
+
+    // find entry of the query
+    try {
+        entry = entryFor(statement, query);
+    } catch (...) {
+        return;
+    }
+
+    // update counters of the query
+    entry->calls.fetch_add(1, std::memory_order_relaxed);
+    entry->totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    entry->buckets[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = entry->maxNanos.load(std::memory_order_relaxed);
+    while (nanos > max
+           && !entry->maxNanos.compare_exchange_weak(
+               max, nanos, std::memory_order_relaxed)) {}
+}
+
+void QueryProfiler::reset() noexcept
+{
+    LockGuard lock(_mutex);
+
+    // entries are kept, because they can be updated right now
+    for (auto& item : _entries) {
+        Entry& entry = *item.second;
+        entry.calls.store(0, std::memory_order_relaxed);
+        entry.totalNanos.store(0, std::memory_order_relaxed);
+        entry.maxNanos.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& bucket : entry.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::vector<QueryProfiler::Stats> QueryProfiler::snapshot() const
+{
+    std::vector<Stats> result;
+
+    LockGuard lock(_mutex);
+    result.reserve(_entries.size());
+
+    // read counters of queries, that were executed since reset
+    for (const auto& item : _entries) {
+        const Entry& entry = *item.second;
+        Stats stats;
+        stats.calls = entry.calls.load(std::memory_order_relaxed);
+        if (!stats.calls) {
+            continue;
+        }
+
+        stats.fingerprint = item.first;
+        stats.totalNanos = entry.totalNanos.load(std::memory_order_relaxed);
+        stats.maxNanos = entry.maxNanos.load(std::memory_order_relaxed);
+        stats.p50Nanos = std::min(percentile(entry, stats.calls, 0.5),
+                                  stats.maxNanos);
+        stats.p99Nanos = std::min(percentile(entry, stats.calls, 0.99),
+                                  stats.maxNanos);
+        result.push_back(std::move(stats));
+    }
+
+    // the most expensive queries go first
+    std::sort(result.begin(), result.end(),
+              [] (const Stats& left, const Stats& right) {
+        return left.totalNanos > right.totalNanos;
+    });
+
+    return result;
+}
+
+void QueryProfiler::detach(sqlite3* const db) noexcept
+{
+    sqlite3_trace_v2(db, 0, NULL, NULL);
+}
+
+std::string QueryProfiler::fingerprint(const char* const query)
+{
+    std::string result;
+    if (!query) {
+        return result;
+    }
+
+    const size_t length = std::strlen(query);
+    result.reserve(length);
+
+    // replace literals and parameters with '?', drop comments, collapse
+    // whitespaces and fold case of keywords and identifiers
+    bool space = false;
+    size_t i = 0;
+    while (i < length) {
+        const unsigned char ch = query[i];
+        const char next = (i + 1 < length) ? query[i + 1] : '\0';
+
+        if (std::isspace(ch)) {
+            space = true;
+            ++i;
+            continue;
+        } else if (ch == '-' && next == '-') {
+            while (i < length && query[i] != '\n') {
+                ++i;
+            }
+            space = true;
+            continue;
+        } else if (ch == '/' && next == '*') {
+            const char* end = std::strstr(query + i + 2, "*/");
+            i = end ? end - query + 2 : length;
+            space = true;
+            continue;
+        }
+
+        if (space && !result.empty()) {
+            result += ' ';
+        }
+        space = false;
+
+        if (ch == '\'' || ((ch == 'x' || ch == 'X') && next == '\'')) {
+            // string or blob literal ('' is escaped quote)
+            i += (ch == '\'') ? 1 : 2;
+            while (i < length) {
+                if (query[i++] == '\'') {
+                    if (i < length && query[i] == '\'') {
+                        ++i;
+                    } else {
+                        break;
+                    }
+                }
+            }
+            result += '?';
+        } else if (ch == '"' || ch == '`' || ch == '[') {
+            // quoted identifier is kept as is
+            const char close = (ch == '[') ? ']' : ch;
+            const size_t start = i++;
+            while (i < length && query[i++] != close) {}
+            result.append(query + start, i - start);
+        } else if (std::isdigit(ch) || (ch == '.' && std::isdigit(next))) {
+            // numeric literal (including hex and exponent)
+            while (i < length && (std::isalnum(query[i]) || query[i] == '.'
+                                  || ((query[i] == '+' || query[i] == '-')
+                                      && (query[i - 1] == 'e'
+                                          || query[i - 1] == 'E')))) {
+                ++i;
+            }
+            result += '?';
+        } else if (ch == '?' || ch == ':' || ch == '@' || ch == '$') {
+            // numbered or named parameter
+            ++i;
+            while (i < length && (std::isalnum(query[i]) || query[i] == '_')) {
+                ++i;
+            }
+            result += '?';
+        } else if (std::isalpha(ch) || ch == '_') {
+            // keyword or identifier
+            while (i < length && (std::isalnum(query[i]) || query[i] == '_'
+                                  || query[i] == '$')) {
+                result += std::tolower(query[i++]);
+            }
+        } else {
+            result += ch;
+            ++i;
+        }
+    }
+
+    return result;
+}
+
+QueryProfiler::Entry* QueryProfiler::entryFor(const void* const statement,
+                                              const char* const query)
+{
+    thread_local std::unordered_map<const void*, Shortcut> shortcuts;
+
+    // fast path: statement was finished by the thread before (entries
+    // are never freed, so cached pointer is valid without lock)
+    auto shortcut = shortcuts.find(statement);
+    if (shortcut != shortcuts.end()
+            && shortcut->second.profilerId == _id
+            && shortcut->second.query.compare(query) == 0) {
+        return shortcut->second.entry;
+    }
+
+    // find (or create) entry of the query fingerprint
+    const std::string key = fingerprint(query);
+    Entry* entry;
+    {
+        LockGuard lock(_mutex);
+        std::unique_ptr<Entry>& value = _entries[key];
+        if (!value) {
+            value.reset(new Entry());
+        }
+        entry = value.get();
+    }
+
+    // remember entry for the statement
+    if (shortcuts.size() >= maxShortcuts) {
+        shortcuts.clear();
+    }
+    Shortcut& value = shortcuts[statement];
+    value.profilerId = _id;
+    value.query = query;
+    value.entry = entry;
+
+    return entry;
+}
+
+int QueryProfiler::bucketOf(const uint64_t nanos) noexcept
+{
+    if (nanos < 4) {
+        return nanos;
+    }
+
+    // power of 2 and two next bits of the value
+    int power = 63;
+    while (!(nanos >> power)) {
+        --power;
+    }
+    return (power - 1) * 4 + ((nanos >> (power - 2)) & 3);
+}
+
+uint64_t QueryProfiler::bucketLimit(const int bucket) noexcept
+{
+    if (bucket < 4) {
+        return bucket;
+    }
+
+    // the greatest value of the bucket
+    const int shift = bucket / 4 - 1;
+    const uint64_t lower = static_cast<uint64_t>(4 + bucket % 4) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+uint64_t QueryProfiler::percentile(const Entry&   entry,
+                                   const uint64_t calls,
+                                   const double   rank) noexcept
+{
+    const uint64_t target = std::max<uint64_t>(std::ceil(calls * rank), 1);
+
+    // find bucket, that contains the value with the rank
+    uint64_t count = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        count += entry.buckets[i].load(std::memory_order_relaxed);
+        if (count >= target) {
+            return bucketLimit(i);
+        }
+    }
+
+    return bucketLimit(bucketCount - 1);
+}
+
+int QueryProfiler::trace(unsigned  type,
+                         void*     context,
+                         void*     statement,
+                         void*     value)
+{
+    // value is time of statement execution in nanoseconds
+    if (type == SQLITE_TRACE_PROFILE) {
+        sqlite3_stmt* const stmt = static_cast<sqlite3_stmt*>(statement);
+        static_cast<QueryProfiler*>(context)->record(
+                    stmt, sqlite3_sql(stmt),
+                    *static_cast<const sqlite3_int64*>(value));
+    }
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include "../include/row_set.h"
+
+// disable asserts in non-debug mode
+#ifndef DEBUG
+#define NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "../include/sqlite3.h"
+#include "../include/statement.h"
+
+
+constexpr size_t ResultArena::defaultBlockSize;
+
+ResultArena::ResultArena(const size_t blockSize) noexcept
+    : _blockSize(std::max<size_t>(blockSize, 64)),
+      _largeBytes(0),
+      _offset(0),
+      _used(0)
+{}
+
+void* ResultArena::allocate(const size_t bytes,
+                            const size_t alignment)
+{
+    // large value gets its own block, so the current block is used further
+    if (bytes > _blockSize / 4) {
+        _large.push_back(std::unique_ptr<char[]>(new char[bytes + alignment]));
+        _largeBytes += bytes + alignment;
+        _used += bytes;
+        return aligned(_large.back().get(), alignment);
+    }
+
+    // take new block, if value does not fit to the current one
+    char* result = _blocks.empty()
+            ? nullptr : aligned(_blocks.back().get() + _offset, alignment);
+    if (!result || result + bytes > _blocks.back().get() + _blockSize) {
+        _blocks.push_back(std::unique_ptr<char[]>(new char[_blockSize]));
+        result = aligned(_blocks.back().get(), alignment);
+    }
+
+    _offset = result + bytes - _blocks.back().get();
+    _used += bytes;
+
+    return result;
+}
+
+size_t ResultArena::blockCount() const noexcept
+{
+    return _blocks.size() + _large.size();
+}
+
+size_t ResultArena::bytesReserved() const noexcept
+{
+    return _blocks.size() * _blockSize + _largeBytes;
+}
+
+size_t ResultArena::bytesUsed() const noexcept
+{
+    return _used;
+}
+
+void ResultArena::clear() noexcept
+{
+    // keep one block for reuse, free the rest at once
+    if (_blocks.size() > 1) {
+        _blocks.erase(_blocks.begin() + 1, _blocks.end());
+    }
+    _large.clear();
+
+    _largeBytes = 0;
+    _offset = 0;
+    _used = 0;
+}
+
+char* ResultArena::aligned(char* const  pointer,
+                           const size_t alignment) noexcept
+{
+    const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return pointer + (alignment - address % alignment) % alignment;
+}
+
+RowSet::RowSet(const size_t blockSize) noexcept
+    : _arena(blockSize),
+      _columnCount(0),
+      _rowCount(0)
+{}
+
+int RowSet::append(const Statement& statement,
+                   const int        maxRows)
+{
+    // rows of other query can not be added
+    const int columns = statement.columnCount();
+    if (_rowCount && columns != _columnCount) {
+        return 0;
+    }
+    _columnCount = columns;
+
+    // copy the rest of rows (or 'maxRows' of them)
+    int result = 0;
+    while ((maxRows < 0 || result < maxRows) && statement.next()) {
+        // cells of failed row are dropped, so rows stay complete (its
+        // text is left in the arena until clear)
+        try {
+            for (int i = 0; i < columns; ++i) {
+                _cells.push_back(copyCell(statement, i));
+            }
+        } catch (...) {
+            _cells.resize(static_cast<size_t>(_rowCount) * columns);
+            throw;
+        }
+
+        ++_rowCount;
+        ++result;
+    }
+
+    return result;
+}
+
+void RowSet::clear() noexcept
+{
+    _arena.clear();
+    _cells.clear();
+    _columnCount = 0;
+    _rowCount = 0;
+}
+
+int RowSet::columnCount() const noexcept
+{
+    return _columnCount;
+}
+
+int RowSet::columnType(const int row,
+                       const int column) const noexcept
+{
+    return cell(row, column).type;
+}
+
+std::pair<const unsigned char*, int> RowSet::getBlob(const int row,
+                                                     const int column)
+const noexcept
+{
+    const std::pair<const char*, int> value = getCStr(row, column);
+
+    return std::pair<const unsigned char*, int>
+    {reinterpret_cast<const unsigned char*>(value.first), value.second};
+}
+
+std::pair<const char*, int> RowSet::getCStr(const int row,
+                                            const int column) const noexcept
+{
+    const Cell& value = cell(row, column);
+
+    // numbers are not converted to text
+    if (value.type != SQLITE_TEXT && value.type != SQLITE_BLOB) {
+        return std::pair<const char*, int>(nullptr, 0);
+    }
+
+    return std::pair<const char*, int>(value.bytes, value.size);
+}
+
+double RowSet::getDouble(const int row,
+                         const int column) const noexcept
+{
+    const Cell& value = cell(row, column);
+
+    switch (value.type) {
+    case SQLITE_FLOAT:
+        return value.real;
+    case SQLITE_INTEGER:
+        return value.integer;
+    default:
+        return 0.0;
+    }
+}
+
+int64_t RowSet::getInt64(const int row,
+                         const int column) const noexcept
+{
+    const Cell& value = cell(row, column);
+
+    switch (value.type) {
+    case SQLITE_INTEGER:
+        return value.integer;
+    case SQLITE_FLOAT:
+        return static_cast<int64_t>(value.real);
+    default:
+        return 0;
+    }
+}
+
+std::string RowSet::getString(const int row,
+                              const int column) const
+{
+    const std::pair<const char*, int> value = getCStr(row, column);
+
+    return value.first ? std::string(value.first, value.second)
+                       : std::string();
+}
+
+bool RowSet::isNull(const int row,
+                    const int column) const noexcept
+{
+    return cell(row, column).type == SQLITE_NULL;
+}
+
+size_t RowSet::memoryUsage() const noexcept
+{
+    return _arena.bytesReserved() + _cells.capacity() * sizeof(Cell);
+}
+
+int RowSet::rowCount() const noexcept
+{
+    return _rowCount;
+}
+
+const RowSet::Cell& RowSet::cell(const int row,
+                                 const int column) const noexcept
+{
+    assert(row >= 0 && row < _rowCount);
+    assert(column >= 0 && column < _columnCount);
+
+    return _cells[row * _columnCount + column];
+}
+
+RowSet::Cell RowSet::copyCell(const Statement& statement,
+                              const int        column)
+{
+    Cell cell;
+    cell.type = statement.columnType(column);
+    cell.size = 0;
+
+    switch (cell.type) {
+    case SQLITE_INTEGER:
+        cell.integer = statement.getInt64(column);
+        break;
+    case SQLITE_FLOAT:
+        cell.real = statement.getDouble(column);
+        break;
+    case SQLITE_TEXT:
+    case SQLITE_BLOB: {
+        // text is kept with terminating zero
+        std::pair<const char*, int> value;
+        if (cell.type == SQLITE_TEXT) {
+            value = statement.getCStr(column);
+        } else {
+            const std::pair<const unsigned char*, int> blob
+                    = statement.getBlob(column);
+            value.first = reinterpret_cast<const char*>(blob.first);
+            value.second = blob.second;
+        }
+        char* const bytes = static_cast<char*>
+                (_arena.allocate(value.second + 1, 1));
+        if (value.second) {
+            std::memcpy(bytes, value.first, value.second);
+        }
+        bytes[value.second] = '\0';
+        cell.bytes = bytes;
+        cell.size = value.second;
+        break;
+    }
+    case SQLITE_NULL:
+    default:
+        cell.integer = 0;
+        break;
+    }
+
+    return cell;
+}
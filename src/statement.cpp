@@ -5,9 +5,11 @@
 #define NDEBUG
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
+#include "../include/busy_handler.h"
 #include "../include/sqlite3.h"
 
 
@@ -15,19 +17,26 @@ Statement::Statement() noexcept
     : _statement(NULL),
       _db(NULL),
       _columnCount(0),
-      _type(Type::Undefined)
+      _type(Type::Undefined),
+      _batchFinished(false)
 {}
 
 Statement::Statement(Statement&& statement) noexcept
     : _statement(statement._statement),
       _db(statement._db),
       _columnCount(statement._columnCount),
-      _type(statement._type)
+      _type(statement._type),
+#ifdef DEBUG
+      _rowGeneration(std::move(statement._rowGeneration)),
+#endif
+      _batchFinished(statement._batchFinished)
 {
+    nextRow();
     statement.reset();
 }
 
 Statement::~Statement() noexcept {
+    nextRow();
     sqlite3_finalize(_statement);
 }
 
@@ -182,6 +191,15 @@ bool Statement::bindString16Copy(const int             index,
             == SQLITE_OK;
 }
 
+bool Statement::bindZeroBlob(const int index,
+                             const int bytes) const noexcept
+{
+    assert(_statement != NULL);
+    assert(index > 0);
+
+    return sqlite3_bind_zeroblob(_statement, index, bytes) == SQLITE_OK;
+}
+
 int32_t Statement::byteLength(const int index) const noexcept
 {
     assert(_statement != NULL);
@@ -238,7 +256,10 @@ bool Statement::execute() const noexcept
 {
     assert(_statement != NULL);
 
-    const bool result = (sqlite3_step(_statement) == SQLITE_DONE);
+    nextRow();
+    _batchFinished = false;
+
+    const bool result = (step() == SQLITE_DONE);
     if (result) {
         sqlite3_reset(_statement);
     }
@@ -260,6 +281,49 @@ std::string Statement::expandedQuery() const
     return result;
 }
 
+int Statement::fetchBatch(ColumnBatch& batch,
+                          const int    maxRows) const
+{
+    assert(_statement != NULL);
+    assert(_type == Statement::Select);
+
+    // empty batch can not be told from the end of rows, so it is refused
+    batch.prepare(_statement, std::max(maxRows, 0));
+    if (maxRows <= 0) {
+        return -1;
+    }
+    nextRow();
+
+    // return empty batch once after the last row (as next() returns false)
+    if (_batchFinished) {
+        _batchFinished = false;
+        return 0;
+    }
+
+    // step up to 'rows' rows and copy them to buffers of the batch (error
+    // is not reported as the end of rows, its code is kept by connection)
+    while (batch._rowCount < maxRows) {
+        const int resultCode = step();
+        if (resultCode == SQLITE_DONE) {
+            _batchFinished = batch._rowCount > 0;
+            break;
+        } else if (resultCode != SQLITE_ROW) {
+            return -1;
+        }
+        batch.appendRow(_statement);
+    }
+
+    return batch._rowCount;
+}
+
+ColumnBatch Statement::fetchBatch(const int maxRows) const
+{
+    ColumnBatch result;
+    fetchBatch(result, maxRows);
+
+    return result;
+}
+
 std::pair<const unsigned char*, int>
 Statement::getBlob(const int index) const noexcept
 {
@@ -293,6 +357,20 @@ std::pair<unsigned char*, int> Statement::getBlobCopy(const int index) const
     return std::pair<unsigned char*, int> {result, bytes};
 }
 
+ColumnView<unsigned char> Statement::getBlobView(const int index) const
+noexcept
+{
+    assert(_statement != NULL);
+    assert(_type == Statement::Select);
+    assert(index >= 0);
+    assert(index < _columnCount);
+
+    const unsigned char* result = reinterpret_cast<const unsigned char*>
+            (sqlite3_column_blob(_statement, index));
+
+    return view(result, sqlite3_column_bytes(_statement, index));
+}
+
 bool Statement::getBool(const int index) const noexcept
 {
     assert(_statement != NULL);
@@ -446,6 +524,32 @@ std::u16string Statement::getString16(const int index) const
     return result;
 }
 
+ColumnView<char> Statement::getTextView(const int index) const noexcept
+{
+    assert(_statement != NULL);
+    assert(_type == Statement::Select);
+    assert(index >= 0);
+    assert(index < _columnCount);
+
+    const char* const ptr = reinterpret_cast<const char*>
+            (sqlite3_column_text(_statement, index));
+
+    return view(ptr, sqlite3_column_bytes(_statement, index));
+}
+
+ColumnView<char16_t> Statement::getText16View(const int index) const noexcept
+{
+    assert(_statement != NULL);
+    assert(_type == Statement::Select);
+    assert(index >= 0);
+    assert(index < _columnCount);
+
+    const char16_t* const ptr = reinterpret_cast<const char16_t*>
+            (sqlite3_column_text16(_statement, index));
+
+    return view(ptr, sqlite3_column_bytes16(_statement, index) >> 1);
+}
+
 bool Statement::isNull(const int index) const noexcept
 {
     assert(_statement != NULL);
@@ -508,7 +612,9 @@ bool Statement::next() const noexcept
     assert(_statement != NULL);
     assert(_type == Type::Select);
 
-    return sqlite3_step(_statement) == SQLITE_ROW;
+    nextRow();
+    _batchFinished = false;
+    return step() == SQLITE_ROW;
 }
 
 std::string Statement::query() const
@@ -525,6 +631,15 @@ std::string Statement::query() const
     return result;
 }
 
+void Statement::rewind() const noexcept
+{
+    assert(_statement != NULL);
+
+    nextRow();
+    _batchFinished = false;
+    sqlite3_reset(_statement);
+}
+
 Statement::Type Statement::type() const noexcept
 {
     return _type;
@@ -539,6 +654,11 @@ Statement& Statement::operator=(Statement&& statement) noexcept
         _db = statement._db;
         _columnCount = statement._columnCount;
         _type = statement._type;
+#ifdef DEBUG
+        _rowGeneration = std::move(statement._rowGeneration);
+#endif
+        _batchFinished = statement._batchFinished;
+        nextRow();
 
         statement.reset();
     }
@@ -551,6 +671,8 @@ void Statement::reset() noexcept
     _db = NULL;
     _columnCount = 0;
     _type = Type::Undefined;
+    _batchFinished = false;
+    nextRow();
 }
 
 Statement::Statement(sqlite3_stmt* statement) noexcept
@@ -558,5 +680,50 @@ Statement::Statement(sqlite3_stmt* statement) noexcept
       _db(statement ? sqlite3_db_handle(statement) : NULL),
       _columnCount(statement ? sqlite3_column_count(statement) : 0),
       _type(statement ? (sqlite3_stmt_readonly(statement)
-                         ? Type::Select : Type::NonSelect) : Type::Undefined)
+                         ? Type::Select : Type::NonSelect) : Type::Undefined),
+      _batchFinished(false)
 {}
+
+void Statement::nextRow() const noexcept
+{
+#ifdef DEBUG
+    if (_rowGeneration) {
+        ++*_rowGeneration;
+    }
+#endif
+}
+
+int Statement::step() const noexcept
+{
+    int resultCode = sqlite3_step(_statement);
+
+    // table of shared cache is locked by another connection, so wait for
+    // unlock notification (if it is enabled) and restart statement
+    while (resultCode == SQLITE_LOCKED
+           && sqlite3_extended_errcode(_db) == SQLITE_LOCKED_SHAREDCACHE
+           && BusyHandler::waitForUnlock(_db)) {
+        sqlite3_reset(_statement);
+        resultCode = sqlite3_step(_statement);
+    }
+
+    return resultCode;
+}
+
+template <typename T>
+ColumnView<T> Statement::view(const T* const data,
+                              const size_t   size) const noexcept
+{
+#ifdef DEBUG
+    // counter is created by the first view (view is not checked, if it
+    // failed)
+    if (!_rowGeneration) {
+        try {
+            _rowGeneration = std::make_shared<uint64_t>(0);
+        } catch (...) {}
+    }
+
+    return ColumnView<T>(data, size, _rowGeneration);
+#else
+    return ColumnView<T>(data, size);
+#endif
+}
@@ -0,0 +1,249 @@
+#include "../include/statement_cache.h"
+
+#include <algorithm>
+
+#include "../include/busy_handler.h"
+#include "../include/sqlite3.h"
+
+
+CachedStatement::CachedStatement() noexcept
+    : _slot(nullptr)
+{}
+
+CachedStatement::CachedStatement(CachedStatement&& lease) noexcept
+    : _cache(std::move(lease._cache)),
+      _slot(lease._slot),
+      _statement(std::move(lease._statement))
+{
+    lease._slot = nullptr;
+}
+
+CachedStatement::CachedStatement(std::weak_ptr<StatementCache>&& cache,
+                                 void* const                     slot,
+                                 Statement&&                     statement)
+noexcept
+    : _cache(std::move(cache)),
+      _slot(slot),
+      _statement(std::move(statement))
+{}
+
+CachedStatement::~CachedStatement() noexcept
+{
+    release();
+}
+
+bool CachedStatement::isValid() const noexcept
+{
+    return _statement.isValid();
+}
+
+void CachedStatement::release() noexcept
+{
+    // return statement to the cache (if cache is still alive)
+    std::shared_ptr<StatementCache> cache = _cache.lock();
+    if (cache && _statement.isValid()) {
+        cache->giveBack(_slot, std::move(_statement));
+    }
+
+    // finalize statement, that was not taken back
+    _statement.clear();
+    _cache.reset();
+    _slot = nullptr;
+}
+
+Statement& CachedStatement::statement() noexcept
+{
+    return _statement;
+}
+
+CachedStatement& CachedStatement::operator=(CachedStatement&& lease) noexcept
+{
+    if (this != &lease) {
+        release();
+
+        _cache = std::move(lease._cache);
+        _slot = lease._slot;
+        _statement = std::move(lease._statement);
+
+        lease._slot = nullptr;
+    }
+
+    return *this;
+}
+
+Statement* CachedStatement::operator->() noexcept
+{
+    return &_statement;
+}
+
+Statement& CachedStatement::operator*() noexcept
+{
+    return _statement;
+}
+
+StatementCache::StatementCache(sqlite3* const db,
+                               const int      capacity) noexcept
+    : _db(db),
+      _capacity(std::max(capacity, 0)),
+      _stats()
+{}
+
+StatementCache::~StatementCache() noexcept
+{
+    close();
+}
+
+CachedStatement StatementCache::acquire(const std::string& query,
+                                        int&               resultCode)
+{
+    // try find idle statement for the query
+    Slots::iterator it = _slots.find(query);
+    if (it != _slots.end() && !it->second.leased) {
+        ++_stats.hits;
+        resultCode = SQLITE_OK;
+
+        // take statement from LRU list and lease it
+        it->second.leased = true;
+        _lru.erase(it->second.position);
+        return CachedStatement(shared_from_this(), &*it,
+                               std::move(it->second.statement));
+    }
+
+    ++_stats.misses;
+
+    // prepare new statement
+    Statement statement = prepare(_db, query, resultCode);
+    if (!statement.isValid()) {
+        return CachedStatement();
+    }
+
+    // statement with the same query is leased already (or caching is off),
+    // so new one will be finalized after use
+    if (it != _slots.end() || !_capacity) {
+        return CachedStatement(shared_from_this(), nullptr,
+                               std::move(statement));
+    }
+
+    // remember new slot and free space for it
+    it = _slots.emplace(query, Slot { Statement(), _lru.end(), true }).first;
+    trim();
+
+    return CachedStatement(shared_from_this(), &*it, std::move(statement));
+}
+
+int StatementCache::capacity() const noexcept
+{
+    return _capacity;
+}
+
+void StatementCache::close() noexcept
+{
+    // finalize idle statements (leased ones will be finalized on release)
+    for (Slots::iterator it = _slots.begin(); it != _slots.end(); ) {
+        if (it->second.leased) {
+            it->second.position = _lru.end();
+            ++it;
+        } else {
+            it = _slots.erase(it);
+        }
+    }
+
+    _lru.clear();
+    _db = nullptr;
+}
+
+void StatementCache::resetStats() noexcept
+{
+    _stats = Stats();
+}
+
+void StatementCache::setCapacity(const int value) noexcept
+{
+    _capacity = std::max(value, 0);
+    trim();
+}
+
+int StatementCache::size() const noexcept
+{
+    return _slots.size();
+}
+
+StatementCache::Stats StatementCache::stats() const noexcept
+{
+    Stats result = _stats;
+    result.size = _slots.size();
+    result.capacity = _capacity;
+
+    return result;
+}
+
+void StatementCache::giveBack(void* const slot,
+                              Statement&& statement) noexcept
+{
+    Slots::value_type* const entry = static_cast<Slots::value_type*>(slot);
+
+    // drop uncached statements and statements of closed connection
+    if (!entry || !_db) {
+        if (entry) {
+            _slots.erase(_slots.find(entry->first));
+        }
+        return;
+    }
+
+    // reset statement and make it most recently used
+    statement.rewind();
+    statement.clearBindings();
+
+    try {
+        _lru.push_front(&entry->first);
+    } catch (...) {
+        _slots.erase(_slots.find(entry->first));
+        return;
+    }
+
+    entry->second.statement = std::move(statement);
+    entry->second.position = _lru.begin();
+    entry->second.leased = false;
+
+    trim();
+}
+
+void StatementCache::trim() noexcept
+{
+    // evict least recently used idle statements
+    while (static_cast<int>(_slots.size()) > _capacity && !_lru.empty()) {
+        const std::string* const key = _lru.back();
+        _lru.pop_back();
+        _slots.erase(_slots.find(*key));
+        ++_stats.evictions;
+    }
+}
+
+Statement StatementCache::prepare(sqlite3* const     db,
+                                  const std::string& query,
+                                  int&               resultCode) noexcept
+{
+    sqlite3_stmt* stmt = nullptr;
+
+    // prepare long-living statement
+    if (db) {
+        resultCode = sqlite3_prepare_v3(db, query.c_str(), query.length(),
+                                        SQLITE_PREPARE_PERSISTENT,
+                                        &stmt, nullptr);
+
+        // schema of shared cache is locked by another connection, so wait
+        // for unlock notification (if it is enabled) and prepare again
+        while (resultCode == SQLITE_LOCKED
+               && sqlite3_extended_errcode(db) == SQLITE_LOCKED_SHAREDCACHE
+               && BusyHandler::waitForUnlock(db)) {
+            resultCode = sqlite3_prepare_v3(db, query.c_str(),
+                                            query.length(),
+                                            SQLITE_PREPARE_PERSISTENT,
+                                            &stmt, nullptr);
+        }
+    } else {
+        resultCode = SQLITE_MISUSE;
+    }
+
+    return Statement(resultCode == SQLITE_OK ? stmt : nullptr);
+}
@@ -0,0 +1,194 @@
+#include "../include/thread_caching_allocator.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "../include/sqlite3.h"
+
+
+namespace {
+
+// header keeps usable size of block (16 bytes keep alignment of data)
+constexpr size_t headerSize = 16;
+
+struct ThreadCache
+{
+    void* lists[ThreadCachingAllocator::classCount];
+    int   counts[ThreadCachingAllocator::classCount];
+
+    ThreadCache() noexcept;
+
+    ~ThreadCache() noexcept;
+};
+
+// state of cache of the current thread (0 - not created, 1 - alive,
+// 2 - destroyed), it is trivial, so it can be read while thread exits
+thread_local int cacheState = 0;
+
+ThreadCache::ThreadCache() noexcept
+    : lists(),
+      counts()
+{
+    cacheState = 1;
+}
+
+ThreadCache::~ThreadCache() noexcept
+{
+    cacheState = 2;
+
+    // return kept blocks to the system allocator
+    for (int i = 0; i < ThreadCachingAllocator::classCount; ++i) {
+        while (lists[i]) {
+            void* const next = *static_cast<void**>(lists[i]);
+            std::free(static_cast<char*>(lists[i]) - headerSize);
+            lists[i] = next;
+        }
+    }
+}
+
+ThreadCache* threadCache() noexcept
+{
+    // blocks are not cached after cache of thread is destroyed
+    if (cacheState == 2) {
+        return nullptr;
+    }
+
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+size_t classSize(const int index) noexcept
+{
+    return ThreadCachingAllocator::maxCachedSize
+            >> (ThreadCachingAllocator::classCount - 1 - index);
+}
+
+}
+
+
+constexpr int    ThreadCachingAllocator::classCount;
+constexpr size_t ThreadCachingAllocator::maxCachedSize;
+constexpr int    ThreadCachingAllocator::maxCachedBlocks;
+
+const sqlite3_mem_methods* ThreadCachingAllocator::methods() noexcept
+{
+    static const sqlite3_mem_methods result {
+        &ThreadCachingAllocator::allocate,
+        &ThreadCachingAllocator::release,
+        &ThreadCachingAllocator::reallocate,
+        &ThreadCachingAllocator::size,
+        &ThreadCachingAllocator::roundUp,
+        &ThreadCachingAllocator::init,
+        &ThreadCachingAllocator::shutdown,
+        NULL
+    };
+
+    return &result;
+}
+
+int ThreadCachingAllocator::classFor(const size_t bytes) noexcept
+{
+    // large block is not cached
+    if (bytes > maxCachedSize) {
+        return -1;
+    }
+
+    int result = 0;
+    while (classSize(result) < bytes) {
+        ++result;
+    }
+
+    return result;
+}
+
+void* ThreadCachingAllocator::allocate(int bytes)
+{
+    if (bytes <= 0) {
+        return NULL;
+    }
+
+    // take block from cache of the current thread
+    const int index = classFor(bytes);
+    if (index >= 0) {
+        ThreadCache* const cache = threadCache();
+        if (cache && cache->lists[index]) {
+            void* const result = cache->lists[index];
+            cache->lists[index] = *static_cast<void**>(result);
+            --cache->counts[index];
+            return result;
+        }
+        bytes = classSize(index);
+    }
+
+    // take new block from the system allocator
+    char* const block = static_cast<char*>(std::malloc(headerSize + bytes));
+    if (!block) {
+        return NULL;
+    }
+    *reinterpret_cast<int64_t*>(block) = bytes;
+
+    return block + headerSize;
+}
+
+void ThreadCachingAllocator::release(void* pointer)
+{
+    if (!pointer) {
+        return;
+    }
+
+    // keep block in cache of the current thread (block can be freed by
+    // another thread, than one allocated it)
+    const int index = classFor(size(pointer));
+    if (index >= 0) {
+        ThreadCache* const cache = threadCache();
+        if (cache && cache->counts[index] < maxCachedBlocks) {
+            *static_cast<void**>(pointer) = cache->lists[index];
+            cache->lists[index] = pointer;
+            ++cache->counts[index];
+            return;
+        }
+    }
+
+    std::free(static_cast<char*>(pointer) - headerSize);
+}
+
+void* ThreadCachingAllocator::reallocate(void* pointer,
+                                         int   bytes)
+{
+    // block is large enough yet
+    const int oldSize = size(pointer);
+    if (bytes <= oldSize) {
+        return pointer;
+    }
+
+    void* const result = allocate(bytes);
+    if (result) {
+        std::memcpy(result, pointer, oldSize);
+        release(pointer);
+    }
+
+    return result;
+}
+
+int ThreadCachingAllocator::size(void* pointer)
+{
+    return pointer ? static_cast<int>(*reinterpret_cast<int64_t*>
+                                      (static_cast<char*>(pointer)
+                                       - headerSize))
+                   : 0;
+}
+
+int ThreadCachingAllocator::roundUp(int bytes)
+{
+    const int index = classFor(bytes);
+    return index >= 0 ? static_cast<int>(classSize(index)) : (bytes + 7) & ~7;
+}
+
+int ThreadCachingAllocator::init(void*)
+{
+    return SQLITE_OK;
+}
+
+void ThreadCachingAllocator::shutdown(void*)
+{}
@@ -0,0 +1,248 @@
+#include "../include/value_traits.h"
+
+#include "../include/sqlite3.h"
+
+
+void* SqliteApi::aggregateContext(sqlite3_context* const context,
+                                  const int              bytes) noexcept
+{
+    return sqlite3_aggregate_context(context, bytes);
+}
+
+bool SqliteApi::bindBlob(sqlite3_stmt* const stmt,
+                         const int           index,
+                         const void* const   value,
+                         const int           bytes,
+                         const bool          copy) noexcept
+{
+    return sqlite3_bind_blob(stmt, index, value, bytes,
+                             copy ? SQLITE_TRANSIENT : SQLITE_STATIC)
+            == SQLITE_OK;
+}
+
+bool SqliteApi::bindDouble(sqlite3_stmt* const stmt,
+                           const int           index,
+                           const double        value) noexcept
+{
+    return sqlite3_bind_double(stmt, index, value) == SQLITE_OK;
+}
+
+bool SqliteApi::bindInt(sqlite3_stmt* const stmt,
+                        const int           index,
+                        const int           value) noexcept
+{
+    return sqlite3_bind_int(stmt, index, value) == SQLITE_OK;
+}
+
+bool SqliteApi::bindInt64(sqlite3_stmt* const stmt,
+                          const int           index,
+                          const int64_t       value) noexcept
+{
+    return sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(value))
+            == SQLITE_OK;
+}
+
+bool SqliteApi::bindNull(sqlite3_stmt* const stmt,
+                         const int           index) noexcept
+{
+    return sqlite3_bind_null(stmt, index) == SQLITE_OK;
+}
+
+bool SqliteApi::bindText(sqlite3_stmt* const stmt,
+                         const int           index,
+                         const char* const   value,
+                         const int           bytes,
+                         const bool          copy) noexcept
+{
+    return sqlite3_bind_text(stmt, index, value, bytes,
+                             copy ? SQLITE_TRANSIENT : SQLITE_STATIC)
+            == SQLITE_OK;
+}
+
+bool SqliteApi::bindText16(sqlite3_stmt* const stmt,
+                           const int           index,
+                           const void* const   value,
+                           const int           bytes,
+                           const bool          copy) noexcept
+{
+    return sqlite3_bind_text16(stmt, index, value, bytes,
+                               copy ? SQLITE_TRANSIENT : SQLITE_STATIC)
+            == SQLITE_OK;
+}
+
+bool SqliteApi::bindZeroBlob(sqlite3_stmt* const stmt,
+                             const int           index,
+                             const int           bytes) noexcept
+{
+    return sqlite3_bind_zeroblob(stmt, index, bytes) == SQLITE_OK;
+}
+
+const void* SqliteApi::columnBlob(sqlite3_stmt* const stmt,
+                                  const int           index) noexcept
+{
+    return sqlite3_column_blob(stmt, index);
+}
+
+int SqliteApi::columnBytes(sqlite3_stmt* const stmt,
+                           const int           index) noexcept
+{
+    return sqlite3_column_bytes(stmt, index);
+}
+
+int SqliteApi::columnBytes16(sqlite3_stmt* const stmt,
+                             const int           index) noexcept
+{
+    return sqlite3_column_bytes16(stmt, index);
+}
+
+double SqliteApi::columnDouble(sqlite3_stmt* const stmt,
+                               const int           index) noexcept
+{
+    return sqlite3_column_double(stmt, index);
+}
+
+int SqliteApi::columnInt(sqlite3_stmt* const stmt,
+                         const int           index) noexcept
+{
+    return sqlite3_column_int(stmt, index);
+}
+
+int64_t SqliteApi::columnInt64(sqlite3_stmt* const stmt,
+                               const int           index) noexcept
+{
+    return sqlite3_column_int64(stmt, index);
+}
+
+bool SqliteApi::columnIsNull(sqlite3_stmt* const stmt,
+                             const int           index) noexcept
+{
+    return sqlite3_column_type(stmt, index) == SQLITE_NULL;
+}
+
+const char* SqliteApi::columnText(sqlite3_stmt* const stmt,
+                                  const int           index) noexcept
+{
+    return reinterpret_cast<const char*>(sqlite3_column_text(stmt, index));
+}
+
+const char16_t* SqliteApi::columnText16(sqlite3_stmt* const stmt,
+                                        const int           index) noexcept
+{
+    return static_cast<const char16_t*>(sqlite3_column_text16(stmt, index));
+}
+
+int SqliteApi::parameterCount(sqlite3_stmt* const stmt) noexcept
+{
+    return sqlite3_bind_parameter_count(stmt);
+}
+
+void SqliteApi::resultBlob(sqlite3_context* const context,
+                           const void* const      value,
+                           const int              bytes) noexcept
+{
+    sqlite3_result_blob(context, value, bytes, SQLITE_TRANSIENT);
+}
+
+void SqliteApi::resultDouble(sqlite3_context* const context,
+                             const double           value) noexcept
+{
+    sqlite3_result_double(context, value);
+}
+
+void SqliteApi::resultError(sqlite3_context* const context,
+                            const char* const      message) noexcept
+{
+    sqlite3_result_error(context, message, -1);
+}
+
+void SqliteApi::resultErrorNoMem(sqlite3_context* const context) noexcept
+{
+    sqlite3_result_error_nomem(context);
+}
+
+void SqliteApi::resultInt(sqlite3_context* const context,
+                          const int              value) noexcept
+{
+    sqlite3_result_int(context, value);
+}
+
+void SqliteApi::resultInt64(sqlite3_context* const context,
+                            const int64_t          value) noexcept
+{
+    sqlite3_result_int64(context, static_cast<sqlite3_int64>(value));
+}
+
+void SqliteApi::resultNull(sqlite3_context* const context) noexcept
+{
+    sqlite3_result_null(context);
+}
+
+void SqliteApi::resultText(sqlite3_context* const context,
+                           const char* const      value,
+                           const int              bytes) noexcept
+{
+    sqlite3_result_text(context, value, bytes, SQLITE_TRANSIENT);
+}
+
+void SqliteApi::resultText16(sqlite3_context* const context,
+                             const void* const      value,
+                             const int              bytes) noexcept
+{
+    sqlite3_result_text16(context, value, bytes, SQLITE_TRANSIENT);
+}
+
+void SqliteApi::resultZeroBlob(sqlite3_context* const context,
+                               const int              bytes) noexcept
+{
+    sqlite3_result_zeroblob(context, bytes);
+}
+
+void* SqliteApi::userData(sqlite3_context* const context) noexcept
+{
+    return sqlite3_user_data(context);
+}
+
+const void* SqliteApi::valueBlob(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_blob(value);
+}
+
+int SqliteApi::valueBytes(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_bytes(value);
+}
+
+int SqliteApi::valueBytes16(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_bytes16(value);
+}
+
+double SqliteApi::valueDouble(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_double(value);
+}
+
+int SqliteApi::valueInt(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_int(value);
+}
+
+int64_t SqliteApi::valueInt64(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_int64(value);
+}
+
+bool SqliteApi::valueIsNull(sqlite3_value* const value) noexcept
+{
+    return sqlite3_value_type(value) == SQLITE_NULL;
+}
+
+const char* SqliteApi::valueText(sqlite3_value* const value) noexcept
+{
+    return reinterpret_cast<const char*>(sqlite3_value_text(value));
+}
+
+const char16_t* SqliteApi::valueText16(sqlite3_value* const value) noexcept
+{
+    return static_cast<const char16_t*>(sqlite3_value_text16(value));
+}
@@ -0,0 +1,82 @@
+#include "../include/wal_connection_group.h"
+
+#include "../include/sqlite3.h"
+
+using LockGuard = std::lock_guard<std::mutex>;
+
+
+constexpr size_t WalConnectionGroup::maxClassifiedQueries;
+
+WalConnectionGroup::WalConnectionGroup(
+        Connection&&                      writer,
+        Connection&&                      classifier,
+        std::shared_ptr<ConnectionPool>&& readers,
+        const int                         maxQueueSize)
+    : _readers(std::move(readers)),
+      _writer(std::move(writer), maxQueueSize),
+      _classifier(std::move(classifier))
+{}
+
+WalConnectionGroup::~WalConnectionGroup() noexcept
+{
+    // finish queued writes before readers are closed
+    stop();
+}
+
+PooledConnection WalConnectionGroup::acquireReader()
+{
+    return _readers->acquire();
+}
+
+bool WalConnectionGroup::isReadQuery(const std::string& query)
+{
+    LockGuard lock(_classifierMutex);
+
+    auto found = _readQueries.find(query);
+    if (found != _readQueries.end()) {
+        return found->second;
+    }
+
+    // type of statement does not depend on schema, so it is kept (failed
+    // statement is not kept, it is passed to the writer to report error)
+    const Statement stmt = _classifier.prepare(query);
+    if (!stmt.isValid()) {
+        return false;
+    }
+
+    if (_readQueries.size() >= maxClassifiedQueries) {
+        _readQueries.clear();
+    }
+    const bool result = isRead(stmt);
+    _readQueries.emplace(query, result);
+
+    return result;
+}
+
+ConnectionPool::Stats WalConnectionGroup::readerStats() const noexcept
+{
+    return _readers->stats();
+}
+
+void WalConnectionGroup::stop() noexcept
+{
+    _writer.stop();
+}
+
+AsyncConnection& WalConnectionGroup::writer() noexcept
+{
+    return _writer;
+}
+
+bool WalConnectionGroup::isRead(const Statement& statement) noexcept
+{
+    // statement does not change database and returns rows (transaction
+    // control statements are read-only too, but belong to the writer)
+    return statement.type() == Statement::Select && statement.columnCount();
+}
+
+bool WalConnectionGroup::isFinished(const Statement& statement) noexcept
+{
+    // all rows are read without error
+    return statement.lastErrorCode() == SQLITE_DONE;
+}
@@ -0,0 +1,142 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/async_connection.h"
+#include "../include/connection.h"
+
+
+static const std::string fileName("test_async.db");
+
+
+std::string testAsyncQueries() {
+    Connection conn(fileName);
+    conn.setStatementCacheCapacity(8);
+    assert(conn.open());
+
+    AsyncConnection async(std::move(conn));
+    assert(async.isRunning());
+
+    // test execute queued queries
+    std::future<bool> created = async.execute("CREATE TABLE Person (id "
+                                              "INTEGER NOT NULL PRIMARY KEY, "
+                                              "name TEXT NOT NULL)");
+    assert(created.get());
+
+    // test execute prepared statement with bound values
+    std::vector<std::future<bool>> inserted;
+    for (int i = 1; i <= 20; ++i) {
+        char name[8];
+        std::snprintf(name, sizeof(name), "p%d", i);
+        inserted.push_back(async.execute("INSERT INTO Person (id, name) "
+                                         "VALUES (?, ?)", i, name));
+    }
+    for (std::future<bool>& result : inserted) {
+        assert(result.get());
+    }
+
+    // test failed query
+    assert(!async.execute("INSERT INTO Person (id, name) VALUES (?, ?)",
+                          1, "mike").get());
+
+    // test read value
+    std::pair<std::string, int> name
+            = async.read<std::string>("SELECT name FROM Person WHERE id = ?",
+                                      7).get();
+    assert(name.first == "p7" && name.second == Connection::ReadSuccess);
+    std::pair<int64_t, int> count
+            = async.read<int64_t>("SELECT count(*) FROM Person").get();
+    assert(count.first == 20 && count.second == Connection::ReadSuccess);
+
+    // test custom work with result and exception
+    std::future<int> rows = async.submit([] (Connection& connection) -> int {
+        Statement s = connection.prepare("SELECT id FROM Person");
+        int result = 0;
+        while (s.next()) {
+            ++result;
+        }
+        return result;
+    });
+    assert(rows.get() == 20);
+
+    std::future<void> failed = async.submit([] (Connection&) {
+        throw std::runtime_error("error");
+    });
+    try {
+        failed.get();
+        assert(false);
+    } catch (std::runtime_error&) {
+    }
+
+    // test stop drains the queue and refuses new work
+    std::future<bool> last = async.execute("DELETE FROM Person");
+    async.stop();
+    assert(!async.isRunning());
+    assert(last.get());
+    assert(!async.execute("DELETE FROM Person").valid());
+
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testBackpressure() {
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+
+    AsyncConnection async(std::move(conn), 2);
+    assert(async.maxQueueSize() == 2);
+
+    // block worker thread
+    std::promise<void> gate;
+    std::shared_future<void> opened(gate.get_future());
+    std::future<void> blocker = async.submit([opened] (Connection&) {
+        opened.wait();
+    });
+    while (async.queueSize()) {
+        std::this_thread::yield();
+    }
+
+    // test queue is bounded
+    std::future<bool> first = async.trySubmit([] (Connection&) {
+        return true;
+    });
+    std::future<bool> second = async.trySubmit([] (Connection&) {
+        return true;
+    });
+    assert(first.valid() && second.valid());
+    std::future<bool> third = async.trySubmit([] (Connection&) {
+        return true;
+    });
+    assert(!third.valid());
+    assert(async.queueSize() == 2);
+
+    // test blocked producer continues, when queue is released
+    std::thread producer([&async] () {
+        assert(async.execute("SELECT 1").get());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gate.set_value();
+    producer.join();
+    blocker.get();
+    assert(first.get() && second.get());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test queued queries on async connection: "
+              << testAsyncQueries() << std::endl;
+    std::cout << "Test async connection queue backpressure: "
+              << testBackpressure() << std::endl;
+
+    return 0;
+}
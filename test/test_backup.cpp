@@ -0,0 +1,126 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../include/backup.h"
+#include "../include/connection.h"
+#include "../include/sqlite3.h"
+#include "../include/statement.h"
+
+
+static const std::string fileName("test_backup.db");
+
+
+void fillSource(Connection& source) {
+    assert(source.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                          "PRIMARY KEY, name TEXT)"));
+    assert(source.transaction());
+    Statement insert = source.prepare("INSERT INTO Person (id, name) "
+                                      "VALUES (?, ?)");
+    for (int i = 1; i <= 2000; ++i) {
+        assert(insert.execute(i, std::string(200, 'a' + i % 26)));
+    }
+    assert(source.commit());
+}
+
+std::string testBackup() {
+    Connection source(fileName);
+    assert(source.open());
+    fillSource(source);
+
+    // test copy by steps with progress
+    Connection destination(Connection::OpenMode::Temporary);
+    assert(destination.open());
+    Backup backup = source.backupTo(destination);
+    assert(backup.isOpen());
+
+    int calls = 0;
+    backup.setProgressHandler([&calls] (int remaining, int total) {
+        assert(remaining >= 0 && remaining < total);
+        ++calls;
+        return true;
+    });
+    assert(backup.run(5, std::chrono::milliseconds(0)));
+    assert(!backup.isOpen() && backup.lastResultCode() == SQLITE_DONE);
+    assert(calls > 10 && backup.restarts() == 0);
+    assert(destination.readInt64("SELECT count(*) FROM Person") == 2000);
+
+    // test backup is restarted, when source is changed by other connection
+    Connection other(fileName);
+    assert(other.open());
+    backup = source.backupTo(destination);
+    assert(backup.step(10) == SQLITE_OK && backup.step(10) == SQLITE_OK);
+    assert(other.execute("DELETE FROM Person WHERE id > 1000"));
+    assert(backup.step(10) == SQLITE_OK && backup.restarts() == 1);
+
+    // test the rest is copied by one step after restart limit
+    assert(backup.run(10, std::chrono::milliseconds(1), 1));
+    assert(destination.readInt64("SELECT count(*) FROM Person") == 1000);
+
+    // test cancel of backup
+    backup = source.backupTo(destination);
+    backup.setProgressHandler([] (int, int) { return false; });
+    assert(!backup.run(10) && backup.lastResultCode() == SQLITE_ABORT);
+    assert(!backup.isOpen());
+
+    // test locked source is waited for (it is unlocked after 50 ms)
+    assert(other.execute("BEGIN EXCLUSIVE"));
+    assert(other.execute("DELETE FROM Person WHERE id > 500"));
+    std::thread writer([&other] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(other.commit());
+    });
+    backup = source.backupTo(destination);
+    const std::chrono::steady_clock::time_point start
+            = std::chrono::steady_clock::now();
+    assert(backup.run(10, std::chrono::milliseconds(0)));
+    assert(std::chrono::steady_clock::now() - start
+           >= std::chrono::milliseconds(40));
+    writer.join();
+    assert(destination.readInt64("SELECT count(*) FROM Person") == 500);
+
+    // test backup fails with the last code after busy retries
+    assert(other.execute("BEGIN EXCLUSIVE"));
+    assert(other.execute("DELETE FROM Person WHERE id > 400"));
+    backup = source.backupTo(destination);
+    assert(!backup.run(10, std::chrono::milliseconds(0),
+                       Backup::defaultMaxRestarts, 3));
+    assert(backup.lastResultCode() == SQLITE_BUSY && !backup.isOpen());
+    assert(other.rollback());
+
+    // test backup to shared-cache database, that is read by other
+    // connection, fails at once
+    Connection shared("backup_shared", Connection::OpenMode::InMemory,
+                      Connection::CacheMode::Shared);
+    Connection sharedReader("backup_shared", Connection::OpenMode::InMemory,
+                            Connection::CacheMode::Shared);
+    assert(shared.open() && sharedReader.open());
+    assert(source.backupTo(shared).run(-1));
+    Statement read = sharedReader.prepare("SELECT id FROM Person");
+    assert(read.next());
+    backup = source.backupTo(shared);
+    assert(!backup.run(10)
+           && backup.lastResultCode() == SQLITE_LOCKED_SHAREDCACHE);
+    read.clear();
+
+    // test backup of closed connection
+    Connection closed;
+    assert(!source.backupTo(closed).isOpen());
+
+    other.close();
+    source.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test online backup by steps: "
+              << testBackup() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/blob_stream.h"
+#include "../include/connection.h"
+#include "../include/statement.h"
+
+
+std::string testReadWrite() {
+    static const int size = 100000;
+    static const int chunk = 4096;
+
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE File (id INTEGER NOT NULL "
+                        "PRIMARY KEY, data BLOB)"));
+
+    // test reserve space with zero blob
+    Statement insert = conn.prepare("INSERT INTO File (id, data) "
+                                    "VALUES (?, ?)");
+    assert(insert.execute(1, ZeroBlob{size}));
+    assert(insert.bindInt(1, 2) && insert.bindZeroBlob(2, size / 2));
+    assert(insert.execute());
+
+    // test write by chunks
+    BlobStream stream = conn.openBlob("File", "data", 1, true);
+    assert(stream.isOpen() && stream.isWritable());
+    assert(stream.size() == size && stream.rowId() == 1);
+
+    std::vector<char> buffer(chunk);
+    int written = 0;
+    while (written < size) {
+        for (int i = 0; i < chunk; ++i) {
+            buffer[i] = static_cast<char>((written + i) % 251);
+        }
+        const int count = stream.write(buffer.data(), chunk);
+        assert(count > 0);
+        written += count;
+    }
+    assert(written == size && stream.position() == size);
+    assert(stream.write(buffer.data(), chunk) == 0);
+
+    // test read by chunks
+    assert(stream.seek(0));
+    int read = 0;
+    int count;
+    while ((count = stream.read(buffer.data(), chunk)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            assert(buffer[i] == static_cast<char>((read + i) % 251));
+        }
+        read += count;
+    }
+    assert(count == 0 && read == size);
+
+    // test random access
+    char value;
+    assert(stream.readAt(&value, 1, 300) && value == 300 % 251);
+    assert(!stream.readAt(&value, 1, size));
+    assert(!stream.seek(size + 1));
+
+    // test reopen handle on another row
+    assert(stream.reopen(2));
+    assert(stream.rowId() == 2 && stream.size() == size / 2);
+    assert(stream.read(buffer.data(), chunk) == chunk && buffer[0] == 0);
+    assert(!stream.reopen(3));
+    assert(stream.close());
+
+    // test read-only stream and not existing row
+    BlobStream readOnly = conn.openBlob("File", "data", 1);
+    assert(readOnly.isOpen() && !readOnly.isWritable());
+    assert(readOnly.write(buffer.data(), 1) == -1);
+    assert(!conn.openBlob("File", "data", 10).isOpen());
+    assert(!conn.openBlob("File", "none", 1).isOpen());
+
+    // test moved stream
+    BlobStream moved(std::move(readOnly));
+    assert(moved.isOpen() && !readOnly.isOpen());
+    assert(moved.read(buffer.data(), 2) == 2 && buffer[1] == 1);
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test incremental blob I/O: "
+              << testReadWrite() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/bulk_inserter.h"
+#include "../include/connection.h"
+
+
+static const std::string fileName("test_bulk.db");
+static const std::string script("CREATE TABLE Person (id INTEGER NOT NULL "
+                                "PRIMARY KEY, name TEXT, weight DOUBLE, "
+                                "binData BLOB);"
+                                "CREATE INDEX PersonName ON Person (name);");
+
+
+std::string testBulkInsert() {
+    static const int rows = 1000;
+    static const unsigned char blob[2] = { 7, 8 };
+
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute(script));
+
+    BulkInserter inserter(conn, "Person", { "id", "name", "weight",
+                                            "binData" });
+    inserter.setMaxRowsPerStatement(64);
+    inserter.setCommitRows(300);
+
+    // test insert rows of different types
+    for (int i = 1; i <= rows; ++i) {
+        if (i % 2) {
+            assert(inserter.add(i, "mike", 70.5,
+                                std::pair<const unsigned char*, int>(blob, 2)));
+        } else {
+            assert(inserter.add(int64_t(i), std::string("kate"),
+                                std::pair<double, bool>(0.0, false),
+                                nullptr));
+        }
+    }
+
+    // test rows are committed by chunks
+    assert(conn.inTransaction());
+    assert(inserter.rowCount() >= 900 && inserter.rowCount() < rows);
+
+    // test finish inserts rest of rows and commits them
+    assert(inserter.finish());
+    assert(!conn.inTransaction());
+    assert(inserter.rowCount() == rows);
+    assert(inserter.rowsPerSecond() > 0.0);
+
+    assert(conn.read<int>("SELECT count(*) FROM Person", nullptr) == rows);
+    assert(conn.read<int>("SELECT count(*) FROM Person "
+                          "WHERE weight IS NULL AND binData IS NULL",
+                          nullptr) == rows / 2);
+    assert(conn.read<std::string>("SELECT name FROM Person WHERE id = ?",
+                                  nullptr, 7) == "mike");
+
+    // test wrong count of values fails insert (and rows are rolled back)
+    BulkInserter other(conn, "Person", { "id", "name" });
+    assert(other.add(rows + 1, "anna"));
+    assert(!other.add(rows + 2, "kate", 50.0));
+    assert(!other.lastError().empty());
+    assert(!other.add(rows + 3, "tom"));
+    assert(!other.finish());
+    assert(conn.read<int>("SELECT count(*) FROM Person", nullptr) == rows);
+
+    // test zero-terminated text is taken for negative size
+    BulkInserter text(conn, "Person", { "id", "name" });
+    assert(text.add(rows + 1, std::pair<const char*, int>("anna", -1)));
+    assert(text.finish());
+    assert(conn.read<std::string>("SELECT name FROM Person WHERE id = ?",
+                                  nullptr, rows + 1) == "anna");
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testRebuildIndexes() {
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute(script));
+
+    {
+        BulkInserter inserter(conn, "Person", { "id", "name" });
+        inserter.setRebuildIndexes(true);
+
+        // test index is dropped during load
+        assert(inserter.add(1, "mike"));
+        assert(conn.read<int>("SELECT count(*) FROM sqlite_master "
+                              "WHERE name = 'PersonName'", nullptr) == 0);
+        assert(inserter.add(2, "kate"));
+
+        // test index is restored by destructor
+    }
+
+    assert(conn.read<int>("SELECT count(*) FROM sqlite_master "
+                          "WHERE name = 'PersonName'", nullptr) == 1);
+    assert(conn.read<int>("SELECT count(*) FROM Person", nullptr) == 2);
+
+    // test failed load (duplicate key) restores index and rolls back
+    BulkInserter inserter(conn, "Person", { "id", "name" });
+    inserter.setRebuildIndexes(true);
+    assert(inserter.add(3, "john"));
+    assert(inserter.add(1, "tom"));
+    assert(!inserter.finish());
+    assert(!inserter.lastError().empty());
+    assert(!conn.inTransaction());
+    assert(conn.read<int>("SELECT count(*) FROM Person", nullptr) == 2);
+    assert(conn.read<int>("SELECT count(*) FROM sqlite_master "
+                          "WHERE name = 'PersonName'", nullptr) == 1);
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testCallerTransaction() {
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute(script));
+
+    // test inserter does not commit transaction of the caller
+    assert(conn.transaction());
+    BulkInserter inserter(conn, "Person", { "id", "name" });
+    inserter.setCommitRows(1);
+    for (int i = 1; i <= 10; ++i) {
+        assert(inserter.add(i, "mike"));
+    }
+    assert(inserter.finish());
+    assert(conn.inTransaction());
+    assert(conn.rollback());
+    assert(conn.read<int>("SELECT count(*) FROM Person", nullptr) == 0);
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test bulk insert of rows: "
+              << testBulkInsert() << std::endl;
+    std::cout << "Test rebuild indexes around bulk insert: "
+              << testRebuildIndexes() << std::endl;
+    std::cout << "Test bulk insert inside caller's transaction: "
+              << testCallerTransaction() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../include/busy_handler.h"
+#include "../include/connection.h"
+#include "../include/statement.h"
+
+
+static const std::string fileName("test_busy.db");
+
+
+std::string testBackoff() {
+    Connection writer(fileName);
+    assert(writer.open());
+    assert(writer.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                          "PRIMARY KEY, name TEXT)"));
+
+    std::shared_ptr<BusyHandler> handler = std::make_shared<BusyHandler>
+            (BusyHandler::Strategy::Backoff, std::chrono::milliseconds(200));
+    handler->setDelays(std::chrono::microseconds(500),
+                       std::chrono::microseconds(5000));
+    Connection other(fileName);
+    other.setBusyHandler(handler);
+    assert(other.open() && other.busyHandler() == handler);
+
+    // test handler gives up after timeout
+    assert(writer.execute("BEGIN IMMEDIATE"));
+    assert(!other.execute("INSERT INTO Person (id, name) VALUES (1, 'a')"));
+    BusyHandler::Stats stats = handler->stats();
+    assert(stats.busyEvents == 1 && stats.timeouts == 1);
+    assert(stats.retries > 0 && stats.waitNanos > 0);
+
+    // test waiting operation succeeds after lock is released
+    handler->resetStats();
+    std::thread release([&writer] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(writer.commit());
+    });
+    Statement insert = other.prepare("INSERT INTO Person (id, name) "
+                                     "VALUES (2, 'b')");
+    assert(insert.execute());
+    release.join();
+    stats = handler->stats();
+    assert(stats.busyEvents == 1 && stats.timeouts == 0 && stats.retries > 0);
+
+    // test removed handler
+    other.setBusyHandler(nullptr);
+    assert(writer.execute("BEGIN IMMEDIATE"));
+    assert(!other.execute("INSERT INTO Person (id, name) VALUES (3, 'c')"));
+    assert(writer.commit());
+    assert(handler->stats().busyEvents == 1);
+
+    writer.close();
+    other.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testUnlockNotify() {
+    Connection writer(fileName, Connection::OpenMode::ReadWriteCreate,
+                      Connection::CacheMode::Shared);
+    assert(writer.open());
+    assert(writer.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                          "PRIMARY KEY, name TEXT)"));
+
+    std::shared_ptr<BusyHandler> handler = std::make_shared<BusyHandler>();
+    handler->setUnlockNotify(true);
+    Connection reader(fileName, Connection::OpenMode::ReadWriteCreate,
+                      Connection::CacheMode::Shared);
+    reader.setBusyHandler(handler);
+    assert(reader.open());
+    Statement select = reader.prepare("SELECT count(*) FROM Person");
+
+    // test reader waits, until writer releases lock of table
+    assert(writer.transaction());
+    assert(writer.execute("INSERT INTO Person (id, name) VALUES (1, 'a')"));
+    std::thread read([&select] () {
+        assert(select.next() && select.getInt(0) == 1);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(writer.commit());
+    read.join();
+
+    const BusyHandler::Stats stats = handler->stats();
+    assert(stats.unlockWaits == 1 && stats.unlockWaitNanos > 0);
+
+    select.clear();
+    writer.close();
+    reader.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test busy handler with backoff: "
+              << testBackoff() << std::endl;
+    std::cout << "Test waiting for unlock notification: "
+              << testUnlockNotify() << std::endl;
+
+    return 0;
+}
@@ -53,6 +53,33 @@ std::string testConnection(Connection&& conn) {
                                        &result);
     assert(sVal == "kate" && result == Connection::ReadSuccess);
 
+    // test typed reads with bound parameters
+    assert(conn.read<int64_t>("SELECT id FROM Person WHERE name = ?",
+                              &result, "mike") == 1);
+    assert(result == Connection::ReadSuccess);
+    assert(conn.read<std::string>("SELECT name FROM Person WHERE id = ?",
+                                  &result, 2) == "kate");
+    assert(result == Connection::ReadSuccess);
+    std::string name("kate");
+    assert(conn.read<double>("SELECT weight FROM Person "
+                             "WHERE id = ? AND name = ?",
+                             &result, 2, name) == 70.9);
+    assert(conn.read<int>("SELECT count(*) FROM Person WHERE weight > ?",
+                          nullptr, 100.0) == 0);
+    assert(conn.read<std::u16string>("SELECT name FROM Person WHERE id = ?",
+                                     &result, int64_t(1)) == u"mike");
+    assert(conn.read<int>("SELECT id FROM Person WHERE id = ?",
+                          &result, 3) == 0);
+    assert(result == Connection::EmptyData);
+
+    // test typed reads with cached statements
+    conn.setStatementCacheCapacity(4);
+    for (int i = 0; i < 3; ++i) {
+        assert(conn.read<std::string>("SELECT name FROM Person WHERE id = ?",
+                                      &result, 1) == "mike");
+    }
+    assert(conn.statementCacheStats().hits == 2);
+
     // test unvalid queries execution
     assert(!conn.execute("INSERT into Person (id, name, weight) "));
     iVal = conn.readInt64("SELECT ids FROM Person WHERE name = \'mike\'",
@@ -170,6 +197,16 @@ std::string testMemoryConnection() {
     Connection conn2("mem1", Connection::OpenMode::InMemory);
     assert(conn2.open());
 
+    // test named in-memory db is shared by connections with shared cache
+    Connection shared1("mem2", Connection::OpenMode::InMemory,
+                       Connection::CacheMode::Shared);
+    Connection shared2("mem2", Connection::OpenMode::InMemory,
+                       Connection::CacheMode::Shared);
+    assert(shared1.open() && shared2.open());
+    assert(shared1.execute("CREATE TABLE Item (id INTEGER PRIMARY KEY)"));
+    assert(shared1.execute("INSERT INTO Item (id) VALUES (1)"));
+    assert(shared2.readInt64("SELECT count(*) FROM Item") == 1);
+
     // test in-memory db connection within name and return result
     return testConnection(std::move(conn2));
 }
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../include/connection.h"
@@ -140,6 +141,205 @@ std::string testOpenInvalidConn() {
     return std::string("OK");
 }
 
+std::string testTuning() {
+    static const std::string tunedName("test_tuned.db");
+
+    // test validation of typed settings
+    ConnectionConfig config;
+    config.setDatabaseName(tunedName);
+    config.setCreateSchemaScript(script);
+    assert(!config.setPageSize(1000) && !config.setPageSize(128));
+    assert(!config.setMmapSize(-1) && !config.setBusyTimeout(-5));
+    assert(!config.setLookaside(64, ConnectionConfig::notSet));
+    assert(config.tuningScript().empty());
+
+    // test presets and equality
+    ConnectionConfig other(config);
+    assert(config.applyPreset("fast-ingest") && !config.applyPreset("none"));
+    assert(config.journalMode() == ConnectionConfig::JournalMode::Wal);
+    assert(config.synchronous() == ConnectionConfig::Synchronous::Normal);
+    assert(!config.equal(other));
+    other.applyPreset(ConnectionConfig::Preset::FastIngest);
+    assert(config.equal(other));
+    assert(other.setPageSize(8192) && !config.equal(other));
+
+    // test tuned connection
+    assert(config.setPageSize(8192) && config.setLookaside(128, 256));
+    assert(config.setBusyTimeout(1000) && config.setCacheSize(-2048));
+    ConnectionCreator creator;
+    assert(creator.addConfig(config, "tuned"));
+    {
+        Connection conn = creator.newConnection("tuned");
+        assert(conn.readInt64("SELECT page_size FROM pragma_page_size")
+               == 8192);
+        assert(conn.readString("SELECT journal_mode "
+                               "FROM pragma_journal_mode") == "wal");
+        assert(conn.readInt64("SELECT synchronous FROM pragma_synchronous")
+               == 1);
+        assert(conn.readInt64("SELECT cache_size FROM pragma_cache_size")
+               == -2048);
+        assert(conn.readInt64("SELECT temp_store FROM pragma_temp_store")
+               == 2);
+        assert(conn.readInt64("SELECT timeout FROM pragma_busy_timeout")
+               == 1000);
+    }
+
+    // test reset of tuning
+    ConnectionConfig plain;
+    plain.setDatabaseName(tunedName);
+    plain.setCreateSchemaScript(script);
+    config.resetTuning();
+    assert(config.tuningScript().empty() && config.equal(plain));
+
+    // test pragmas are kept in order of applying
+    assert(config.setMmapSize(0) && config.setPageSize(4096));
+    assert(config.tuningScript() == "PRAGMA page_size = 4096;"
+                                    "PRAGMA mmap_size = 0;");
+
+    std::remove(tunedName.c_str());
+    std::remove((tunedName + "-wal").c_str());
+    std::remove((tunedName + "-shm").c_str());
+
+    return std::string("OK");
+}
+
+std::string testConfigSnapshot() {
+    ConnectionConfig config;
+    config.setDatabaseName(std::string("first.db"));
+
+    ConnectionCreator creator;
+    assert(creator.addConfig(config, "default"));
+
+    // test snapshot is kept, when config is replaced
+    std::shared_ptr<const ConnectionConfig> snapshot
+            = creator.configSnapshot("default");
+    assert(snapshot && snapshot->databaseName() == "first.db");
+    assert(creator.configSnapshot("default") == snapshot);
+    config.setDatabaseName(std::string("second.db"));
+    assert(creator.replaceConfig("default", config));
+    assert(snapshot->databaseName() == "first.db");
+    assert(creator.configSnapshot("default")->databaseName() == "second.db");
+    assert(!creator.configSnapshot("none"));
+
+    // test lookups, while configs are changed by another thread
+    std::thread writer([&creator, config] () {
+        for (int i = 0; i < 1000; ++i) {
+            creator.addOrReplaceConfig(config,
+                                       "config" + std::to_string(i % 10));
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        std::shared_ptr<const ConnectionConfig> value
+                = creator.configSnapshot("default");
+        assert(value && value->databaseName() == "second.db");
+    }
+    writer.join();
+    assert(creator.configsCount() == 11);
+
+    // test snapshot cached by thread is not used after move
+    ConnectionCreator moved(std::move(creator));
+    assert(creator.configsCount() == 0 && moved.configsCount() == 11);
+
+    return std::string("OK");
+}
+
+std::string testMigrations() {
+    static const std::string migratedName("test_migrate.db");
+    static const std::string versionQuery("SELECT user_version "
+                                          "FROM pragma_user_version");
+
+    // test migration steps validation
+    ConnectionConfig config;
+    config.setDatabaseName(migratedName);
+    assert(config.addMigration(2, "ALTER TABLE Person ADD COLUMN age INT"));
+    assert(config.addMigration(1, "CREATE TABLE Person (id INTEGER NOT NULL "
+                                  "PRIMARY KEY, name TEXT NOT NULL)"));
+    assert(!config.addMigration(1, "SELECT 1") && !config.addMigration(0, "x"));
+    assert(config.schemaVersion() == 2);
+
+    // test steps are executed in order of versions
+    ConnectionCreator creator;
+    assert(creator.addConfig(config, "migrated"));
+    {
+        Connection conn = creator.newConnection("migrated");
+        assert(conn.readInt64(versionQuery) == 2);
+        assert(conn.execute("INSERT INTO Person (id, name, age) "
+                            "VALUES (1, 'mike', 30)"));
+    }
+
+    // test only new step is executed after upgrade of config
+    assert(config.addMigration(3, "CREATE INDEX PersonName ON Person(name)"));
+    assert(creator.replaceConfig("migrated", config));
+    {
+        Connection conn = creator.newConnection("migrated");
+        assert(conn.readInt64(versionQuery) == 3);
+        assert(conn.readInt64("SELECT count(*) FROM Person") == 1);
+
+        // version is changed to check, that steps are not executed again
+        assert(conn.execute("PRAGMA user_version = 1"));
+    }
+
+    // test migrated database is not checked again by the same creator
+    {
+        Connection conn = creator.newConnection("migrated");
+        assert(conn.readInt64(versionQuery) == 1);
+    }
+
+    // test failed step is rolled back (column exists already)
+    ConnectionCreator other;
+    assert(other.addConfig(config, "migrated"));
+    try {
+        Connection conn = other.newConnection("migrated");
+        throw std::runtime_error("Migration step must fail!");
+    } catch (const CreateConnException&) {
+    }
+    {
+        Connection conn = creator.newConnection("migrated");
+        assert(conn.readInt64(versionQuery) == 1);
+    }
+
+    std::remove(migratedName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testPrewarm() {
+    static const std::string warmName("test_warm.db");
+
+    ConnectionConfig config;
+    config.setDatabaseName(warmName);
+    config.setCreateSchemaScript(script);
+    config.setBusyTimeout(5000);
+
+    ConnectionCreator creator;
+    assert(creator.addConfig(config, "warm"));
+
+    // test connections are opened by several threads
+    std::vector<Connection> connections = creator.prewarm("warm", 16, 4);
+    assert(connections.size() == 16);
+    for (Connection& conn : connections) {
+        assert(conn.isOpen());
+        assert(conn.readInt64("SELECT count(*) FROM sqlite_master "
+                              "WHERE name = 'Person'") == 1);
+    }
+    assert(creator.prewarm("warm", 0).empty());
+
+    // test error of any connection is thrown
+    config.setOpenMode(Connection::OpenMode::ReadOnly);
+    config.setDatabaseName(std::string("not_existing.db"));
+    assert(creator.addConfig(config, "invalid"));
+    try {
+        creator.prewarm("invalid", 4);
+        throw std::runtime_error("Connections must not be opened!");
+    } catch (const CreateConnException&) {
+    }
+
+    connections.clear();
+    std::remove(warmName.c_str());
+
+    return std::string("OK");
+}
+
 int main() {
 
     std::cout << "Add, replace, remove connection config: "
@@ -147,5 +347,13 @@ int main() {
     std::cout << "Open valid connection: " << testOpenConn() << std::endl;
     std::cout << "Open connection with invalid config (or config name): "
               << testOpenInvalidConn() << std::endl;
+    std::cout << "Migrate schema by user version: "
+              << testMigrations() << std::endl;
+    std::cout << "Open connections in parallel: "
+              << testPrewarm() << std::endl;
+    std::cout << "Read config snapshots without lock: "
+              << testConfigSnapshot() << std::endl;
+    std::cout << "Open connection with typed tuning settings: "
+              << testTuning() << std::endl;
     return 0;
 }
@@ -0,0 +1,169 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/connection_config.h"
+#include "../include/connection_creator.h"
+#include "../include/connection_pool.h"
+#include "../include/create_conn_exception.h"
+
+
+static const std::string script("PRAGMA foreign_keys = off;"
+                                "BEGIN TRANSACTION; "
+                                "CREATE TABLE Person (id INTEGER NOT NULL "
+                                "PRIMARY KEY, name TEXT NOT NULL);"
+                                "COMMIT TRANSACTION;"
+                                "PRAGMA foreign_keys = on;");
+static const std::string fileName("test_pool.db");
+
+
+ConnectionCreator* makeCreator() {
+    ConnectionConfig config;
+    config.setDatabaseName(fileName);
+    config.setCreateSchemaScript(script);
+
+    ConnectionCreator* creator = new ConnectionCreator();
+    assert(creator->addConfig(config, "default"));
+
+    return creator;
+}
+
+std::string testAcquireRelease() {
+    ConnectionCreator* creator = makeCreator();
+
+    // test pool for not existing config
+    assert(!creator->createPool("other", 1, 2));
+    try {
+        creator->acquireConnection("default");
+        throw std::runtime_error("Pool must not exists!");
+    } catch (CreateConnException& e) {
+    }
+
+    // test create pool (minimal number of connections opened at once)
+    assert(creator->createPool("default", 1, 2,
+                               std::chrono::milliseconds(20)));
+    std::pair<ConnectionPool::Stats, bool> stats
+            = creator->poolStats("default");
+    assert(stats.second && stats.first.idle == 1 && stats.first.inUse == 0);
+    assert(stats.first.maxSize == 2);
+
+    {
+        // test acquire configured connection
+        PooledConnection first = creator->acquireConnection("default");
+        assert(first.isValid() && first->isOpen());
+        assert(first->execute("INSERT INTO Person (id, name) "
+                              "VALUES (1, 'mike')"));
+
+        // test acquire second connection (opened on demand)
+        PooledConnection second = creator->acquireConnection("default");
+        assert(second.isValid());
+        assert(second->readInt64("SELECT count(*) FROM Person") == 1);
+
+        // test timeout when pool is saturated
+        try {
+            creator->acquireConnection("default");
+            throw std::runtime_error("Pool must be saturated!");
+        } catch (CreateConnException& e) {
+        }
+
+        stats = creator->poolStats("default");
+        assert(stats.first.inUse == 2 && stats.first.idle == 0);
+        assert(stats.first.saturated == 1 && stats.first.timeouts == 1);
+        assert(stats.first.peakInUse == 2);
+
+        // test release lease with unfinished transaction
+        assert(second->transaction());
+        assert(second->execute("INSERT INTO Person (id, name) "
+                               "VALUES (2, 'kate')"));
+        second.release();
+        assert(!second.isValid());
+
+        // test reuse returned connection
+        PooledConnection third = creator->acquireConnection("default");
+        assert(!third->inTransaction());
+        assert(third->readInt64("SELECT count(*) FROM Person") == 1);
+    }
+
+    stats = creator->poolStats("default");
+    assert(stats.first.idle == 2 && stats.first.inUse == 0);
+    assert(stats.first.acquired == 3);
+
+    // test delete pool
+    assert(creator->deletePool("default"));
+    assert(!creator->poolStats("default").second);
+    assert(!creator->deletePool("default"));
+
+    delete creator;
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testLeaseOutlivesPool() {
+    ConnectionCreator* creator = makeCreator();
+    assert(creator->createPool("default", 0, 1));
+
+    // test replace config drops the pool, but not active leases
+    PooledConnection lease = creator->acquireConnection("default");
+    creator->addOrReplaceConfig(ConnectionConfig(), "default");
+    assert(!creator->poolStats("default").second);
+    assert(lease->isOpen());
+
+    delete creator;
+    lease.release();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testConcurrentAcquire() {
+    static const int threadsCount = 8;
+    static const int iterations = 50;
+
+    ConnectionCreator* creator = makeCreator();
+    assert(creator->createPool("default", 1, 3,
+                               std::chrono::milliseconds(10000)));
+
+    // test many threads sharing few connections
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadsCount; ++i) {
+        threads.emplace_back([creator] () {
+            for (int j = 0; j < iterations; ++j) {
+                PooledConnection lease = creator->acquireConnection("default");
+                assert(lease->readInt64("SELECT count(*) FROM Person") == 0);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::pair<ConnectionPool::Stats, bool> stats
+            = creator->poolStats("default");
+    assert(stats.first.acquired == threadsCount * iterations);
+    assert(stats.first.peakInUse <= 3 && stats.first.timeouts == 0);
+    assert(stats.first.inUse == 0);
+
+    delete creator;
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Acquire and release pooled connections: "
+              << testAcquireRelease() << std::endl;
+    std::cout << "Lease outlives its pool: "
+              << testLeaseOutlivesPool() << std::endl;
+    std::cout << "Acquire pooled connections from many threads: "
+              << testConcurrentAcquire() << std::endl;
+
+    return 0;
+}
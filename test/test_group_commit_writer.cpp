@@ -0,0 +1,141 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/group_commit_writer.h"
+
+
+static const std::string fileName("test_group.db");
+
+
+std::string testGroupCommit() {
+    static const int threadCount = 8;
+    static const int writesPerThread = 200;
+
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT)"));
+
+    Connection writerConn(fileName);
+    assert(writerConn.open());
+    writerConn.setStatementCacheCapacity(16);
+    GroupCommitWriter writer(std::move(writerConn), 64,
+                             std::chrono::milliseconds(5));
+    assert(writer.isRunning() && writer.maxBatchSize() == 64);
+
+    // test writes of many threads are committed by a few transactions
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&writer, t] () {
+            for (int i = 0; i < writesPerThread; ++i) {
+                const int id = t * writesPerThread + i + 1;
+                std::future<bool> result = writer.execute(
+                            "INSERT INTO Person (id, name) VALUES (?, ?)",
+                            id, "person " + std::to_string(id));
+                assert(result.get());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const int total = threadCount * writesPerThread;
+    assert(conn.readInt64("SELECT count(*) FROM Person") == total);
+    GroupCommitWriter::Stats stats = writer.stats();
+    assert(stats.writes == static_cast<uint64_t>(total));
+    assert(stats.batches < stats.writes && stats.failedWrites == 0);
+
+    // test failed write is rolled back alone (id exists already)
+    std::future<bool> failed = writer.execute("INSERT INTO Person (id, name) "
+                                              "VALUES (1, 'copy')");
+    std::future<bool> thrown = writer.submit([] (Connection& c) -> bool {
+        c.execute("INSERT INTO Person (id, name) VALUES (-2, 'x')");
+        throw std::runtime_error("write error");
+    });
+    std::future<bool> passed = writer.execute("INSERT INTO Person (id, name) "
+                                              "VALUES (-1, 'new')");
+    assert(!failed.get() && passed.get());
+    try {
+        thrown.get();
+        throw std::logic_error("Exception must be passed to the future!");
+    } catch (std::runtime_error&) {
+    }
+    assert(conn.readInt64("SELECT count(*) FROM Person") == total + 1);
+    assert(writer.stats().failedWrites == 2);
+
+    // test writes are not accepted after stop
+    writer.stop();
+    assert(!writer.isRunning());
+    assert(!writer.execute("DELETE FROM Person").valid());
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testStopWhileSubmit() {
+    static const int threadCount = 4;
+
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT)"));
+    GroupCommitWriter writer(std::move(conn), 16,
+                             std::chrono::milliseconds(1));
+
+    // test every accepted write is completed by stop
+    std::vector<std::vector<std::future<bool>>> results(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&writer, &results, t] () {
+            while (true) {
+                std::future<bool> result = writer.execute(
+                            "INSERT INTO Person (name) VALUES ('mike')");
+                if (!result.valid()) {
+                    break;
+                }
+                results[t].push_back(std::move(result));
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writer.stop();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t writes = 0;
+    for (std::vector<std::future<bool>>& items : results) {
+        for (std::future<bool>& result : items) {
+            assert(result.wait_for(std::chrono::seconds(0))
+                   == std::future_status::ready);
+            assert(result.get());
+            ++writes;
+        }
+    }
+    assert(writes > 0 && writer.stats().writes == writes);
+
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test group commit of writes of many threads: "
+              << testGroupCommit() << std::endl;
+    std::cout << "Test stop of writer while writes are submitted: "
+              << testStopWhileSubmit() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/statement.h"
+
+
+std::string fillDatabase() {
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT)"));
+
+    assert(conn.transaction());
+    Statement s = conn.prepare("INSERT INTO Person(id,name) VALUES(?,?)");
+    for (int i = 1; i <= 2000; ++i) {
+        assert(s.execute(i, "person " + std::to_string(i)));
+    }
+    assert(conn.commit());
+
+    assert(conn.readInt64("SELECT count(*) FROM Person") == 2000);
+    assert(conn.readString("SELECT name FROM Person WHERE id = 7")
+           == "person 7");
+
+    return std::string("OK");
+}
+
+std::string testMemoryConfig() {
+    // test configure memory before any connection is opened
+    assert(Connection::setMemoryStatus(true) == Connection::Ok);
+    assert(Connection::setPageCache(4096, 64) == Connection::Ok);
+    assert(Connection::setDefaultLookaside(128, 64) == Connection::Ok);
+    assert(Connection::setAllocator(Connection::Allocator::ThreadCaching)
+           == Connection::Ok);
+    assert(Connection::allocator() == Connection::Allocator::ThreadCaching);
+
+    // test memory can not be configured, while connection is opened
+    {
+        Connection conn(Connection::OpenMode::Temporary);
+        assert(conn.open());
+        assert(Connection::memoryUsed() > 0);
+        assert(Connection::memoryHighwater() >= Connection::memoryUsed());
+        assert(Connection::setAllocator(Connection::Allocator::Default) == -1);
+        assert(Connection::setPageCache(0, 0) == -1);
+        assert(Connection::setMemoryStatus(false) == -1);
+    }
+
+    // test connections of several threads use the thread-caching allocator
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back(fillDatabase);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // test restore default configuration
+    assert(Connection::setAllocator(Connection::Allocator::Default)
+           == Connection::Ok);
+    assert(Connection::allocator() == Connection::Allocator::Default);
+    assert(Connection::setPageCache(0, 0) == Connection::Ok);
+    assert(Connection::setMemoryStatus(false) == Connection::Ok);
+    assert(fillDatabase() == "OK");
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test process-wide memory configuration: "
+              << testMemoryConfig() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../include/connection.h"
+#include "../include/memory_replica.h"
+
+
+static const std::string fileName("test_replica.db");
+
+
+std::string testReplica() {
+    Connection file(fileName);
+    assert(file.open());
+    assert(file.execute("CREATE TABLE Country (code TEXT NOT NULL "
+                        "PRIMARY KEY, name TEXT NOT NULL);"
+                        "INSERT INTO Country VALUES ('ua', 'Ukraine');"
+                        "INSERT INTO Country VALUES ('pl', 'Poland');"));
+
+    // test hydrate in-memory database from file
+    MemoryReplica replica("replica1", fileName);
+    assert(!replica.isLoaded() && !replica.refresh());
+    assert(replica.load() && replica.isLoaded());
+    Connection reader = replica.connect();
+    assert(reader.isOpen());
+    assert(reader.busyHandler() && reader.busyHandler()->unlockNotify());
+    assert(reader.readString("SELECT name FROM Country WHERE code = 'ua'")
+           == "Ukraine");
+
+    // test refresh after file is changed
+    assert(file.execute("INSERT INTO Country VALUES ('de', 'Germany')"));
+    assert(reader.readInt64("SELECT count(*) FROM Country") == 2);
+    assert(replica.refresh());
+    assert(reader.readInt64("SELECT count(*) FROM Country") == 3);
+
+    // test persist changes of in-memory database
+    assert(reader.execute("DELETE FROM Country WHERE code = 'pl'"));
+    assert(replica.persist());
+    assert(file.readInt64("SELECT count(*) FROM Country") == 2);
+
+    // test periodic refresh
+    assert(replica.startSync(std::chrono::milliseconds(10)));
+    assert(!replica.startSync(std::chrono::milliseconds(10)));
+    assert(file.execute("INSERT INTO Country VALUES ('fr', 'France')"));
+    const int syncCount = replica.syncCount();
+    while (replica.syncCount() < syncCount + 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    replica.stopSync();
+    assert(reader.readInt64("SELECT count(*) FROM Country") == 3);
+
+    // test reader waits for refresh instead of failing
+    std::thread refresher([&replica] () {
+        for (int i = 0; i < 50; ++i) {
+            assert(replica.refresh());
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        assert(reader.readInt64("SELECT count(*) FROM Country") == 3);
+    }
+    refresher.join();
+
+    // test replica of not existing file is not loaded
+    MemoryReplica invalid("replica2", "not_existing.db");
+    assert(!invalid.load() && !invalid.lastError().empty());
+
+    reader.close();
+    file.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test in-memory replica of database file: "
+              << testReplica() << std::endl;
+
+    return 0;
+}
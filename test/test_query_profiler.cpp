@@ -0,0 +1,117 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/query_profiler.h"
+#include "../include/statement.h"
+
+
+std::string testFingerprint() {
+    // test literals, parameters, comments and case are normalized
+    assert(QueryProfiler::fingerprint("SELECT  name FROM Person\n"
+                                      "WHERE id = 10 AND name = 'it''s'")
+           == "select name from person where id = ? and name = ?");
+    assert(QueryProfiler::fingerprint("select name from person "
+                                      "where id = ?1 and name = :name")
+           == "select name from person where id = ? and name = ?");
+    assert(QueryProfiler::fingerprint("INSERT INTO t VALUES (1.5e-3, "
+                                      "x'0A0B', -- comment\n 0x1F) "
+                                      "/* other */")
+           == "insert into t values (?, ?, ?)");
+
+    // test quoted identifiers are kept
+    assert(QueryProfiler::fingerprint("SELECT \"Name 1\" FROM [My Table]")
+           == "select \"Name 1\" from [My Table]");
+    assert(QueryProfiler::fingerprint(nullptr).empty());
+
+    return std::string("OK");
+}
+
+std::string testProfiling() {
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(!conn.profiler());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT NOT NULL)"));
+
+    // test profiler is attached to opened connection
+    std::shared_ptr<QueryProfiler> profiler
+            = std::make_shared<QueryProfiler>();
+    conn.setProfiler(profiler);
+    assert(conn.profiler() == profiler);
+
+    Statement insert = conn.prepare("INSERT INTO Person (id, name) "
+                                    "VALUES (?, ?)");
+    for (int i = 1; i <= 100; ++i) {
+        assert(insert.execute(i, "mike"));
+    }
+    for (int i = 1; i <= 10; ++i) {
+        assert(conn.execute("DELETE FROM Person WHERE id = "
+                            + std::to_string(i)));
+    }
+
+    // test statistics are grouped by fingerprint
+    std::vector<QueryProfiler::Stats> stats = profiler->snapshot();
+    assert(stats.size() == 2);
+    for (const QueryProfiler::Stats& item : stats) {
+        if (item.fingerprint == "insert into person (id, name) "
+                                "values (?, ?)") {
+            assert(item.calls == 100);
+        } else {
+            assert(item.fingerprint == "delete from person where id = ?");
+            assert(item.calls == 10);
+        }
+        assert(item.p50Nanos <= item.p99Nanos);
+        assert(item.p99Nanos <= item.maxNanos);
+        assert(item.maxNanos <= item.totalNanos);
+    }
+
+    // test reset
+    profiler->reset();
+    assert(profiler->snapshot().empty());
+
+    // test disabled profiler records nothing
+    conn.setProfiler(nullptr);
+    assert(insert.execute(1000, "kate"));
+    assert(profiler->snapshot().empty());
+
+    // test profiler is shared and attached on open
+    Connection other(Connection::OpenMode::Temporary);
+    other.setProfiler(profiler);
+    conn.setProfiler(profiler);
+    assert(other.open());
+    assert(other.execute("SELECT 1"));
+    assert(conn.execute("SELECT 2"));
+    stats = profiler->snapshot();
+    assert(stats.size() == 1 && stats[0].calls == 2);
+
+    // test statement is counted by new profiler after switch
+    std::shared_ptr<QueryProfiler> next = std::make_shared<QueryProfiler>();
+    profiler->reset();
+    conn.setProfiler(next);
+    assert(insert.execute(1001, "kate"));
+    assert(profiler->snapshot().empty());
+    stats = next->snapshot();
+    assert(stats.size() == 1 && stats[0].calls == 1);
+
+    // test profiler is detached from closed connection
+    conn.close();
+    assert(insert.execute(1002, "kate"));
+    stats = next->snapshot();
+    assert(stats.size() == 1 && stats[0].calls == 1);
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test SQL fingerprints: "
+              << testFingerprint() << std::endl;
+    std::cout << "Test query profiling: "
+              << testProfiling() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/row_set.h"
+#include "../include/sqlite3.h"
+#include "../include/statement.h"
+
+
+std::string testArena() {
+    ResultArena arena(1024);
+
+    // test aligned allocations from one block
+    char* first = static_cast<char*>(arena.allocate(10, 1));
+    int64_t* second = static_cast<int64_t*>(arena.allocate(sizeof(int64_t),
+                                                           alignof(int64_t)));
+    assert(reinterpret_cast<uintptr_t>(second) % alignof(int64_t) == 0);
+    assert(reinterpret_cast<char*>(second) >= first + 10);
+    assert(arena.blockCount() == 1 && arena.bytesUsed() == 18);
+
+    // test large value gets own block, the current one is used further
+    char* large = static_cast<char*>(arena.allocate(4000, 1));
+    std::memset(large, 1, 4000);
+    char* third = static_cast<char*>(arena.allocate(8, 1));
+    assert(third >= first && third < first + 1024);
+    assert(arena.blockCount() == 2);
+
+    // test new block is taken, when current one is full
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(200, 1);
+    }
+    assert(arena.blockCount() > 2);
+    assert(arena.bytesReserved() >= arena.bytesUsed());
+
+    // test clear keeps one block
+    arena.clear();
+    assert(arena.blockCount() == 1 && arena.bytesUsed() == 0);
+
+    return std::string("OK");
+}
+
+std::string testRowSet() {
+    static const unsigned char blob[3] = { 1, 0, 2 };
+
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, weight DOUBLE, "
+                        "binData BLOB)"));
+
+    Statement s = conn.prepare("INSERT INTO Person(id,name,weight,binData) "
+                               "VALUES(?,?,?,?)");
+    for (int i = 1; i <= 1000; ++i) {
+        if (i % 100) {
+            assert(s.execute(i, "person " + std::to_string(i), i * 0.5,
+                             std::pair<const unsigned char*, int>(blob, 3)));
+        } else {
+            assert(s.execute(i, nullptr, nullptr, nullptr));
+        }
+    }
+
+    // test copy part of rows and then the rest of them
+    s = conn.prepare("SELECT id, name, weight, binData FROM Person "
+                     "ORDER BY id");
+    RowSet rows(4096);
+    assert(rows.append(s, 10) == 10);
+    assert(rows.append(s) == 990);
+    assert(rows.rowCount() == 1000 && rows.columnCount() == 4);
+
+    // test rows are kept after statement is finalized
+    s.clear();
+    assert(rows.getInt64(0, 0) == 1 && rows.getInt64(999, 0) == 1000);
+    assert(rows.columnType(0, 1) == SQLITE_TEXT);
+    assert(rows.getString(41, 1) == "person 42");
+    assert(std::strcmp(rows.getCStr(41, 1).first, "person 42") == 0);
+    assert(rows.getDouble(3, 2) == 2.0);
+    assert(rows.getBlob(5, 3).second == 3 && rows.getBlob(5, 3).first[2] == 2);
+
+    // test null values
+    assert(rows.isNull(99, 1) && rows.isNull(99, 2) && rows.isNull(99, 3));
+    assert(rows.getCStr(99, 1).first == nullptr);
+    assert(rows.getString(99, 1).empty() && rows.getInt64(99, 2) == 0);
+    assert(!rows.isNull(98, 1));
+
+    // test memory is taken by a few large blocks
+    assert(rows.memoryUsage() > 0);
+
+    // test clear
+    rows.clear();
+    assert(rows.rowCount() == 0 && rows.columnCount() == 0);
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test bump-allocated result arena: "
+              << testArena() << std::endl;
+    std::cout << "Test materialized row set: "
+              << testRowSet() << std::endl;
+
+    return 0;
+}
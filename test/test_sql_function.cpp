@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/sqlite3.h"
+#include "../include/statement.h"
+
+
+// median of values (NULL for empty group)
+struct Median
+{
+    std::vector<double> values;
+
+    void step(std::pair<double, bool> value) {
+        if (value.second) {
+            values.push_back(value.first);
+        }
+    }
+
+    std::pair<double, bool> final() {
+        if (values.empty()) {
+            return std::pair<double, bool>(0.0, false);
+        }
+        std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                         values.end());
+        return std::pair<double, bool>(values[values.size() / 2], true);
+    }
+};
+
+// the most frequent text (the first one in order of text for equal counts)
+struct TopText
+{
+    std::map<std::string, int> counts;
+
+    void step(const std::string& text, int weight) {
+        if (weight < 0) {
+            throw std::invalid_argument("negative weight");
+        }
+        counts[text] += weight;
+    }
+
+    std::string final() const {
+        std::string result;
+        int best = 0;
+        for (const auto& item : counts) {
+            if (item.second > best) {
+                result = item.first;
+                best = item.second;
+            }
+        }
+        return result;
+    }
+};
+
+// live states are counted to check they are destroyed
+struct Counter
+{
+    static int alive;
+
+    int64_t count;
+
+    Counter() : count(0) {
+        ++alive;
+    }
+
+    ~Counter() {
+        --alive;
+    }
+
+    void step() {
+        ++count;
+    }
+
+    int64_t final() const {
+        return count;
+    }
+};
+
+int Counter::alive = 0;
+
+static int64_t square(const int64_t value) {
+    return value * value;
+}
+
+std::string testScalarFunction() {
+    Connection conn(Connection::OpenMode::Temporary);
+
+    // test function is not registered on closed connection
+    assert(!conn.createFunction("twice", [](int value) { return value * 2; }));
+    assert(conn.lastResultCode() == SQLITE_MISUSE);
+
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, weight DOUBLE)"));
+    Statement s = conn.prepare("INSERT INTO Person(id,name,weight) "
+                               "VALUES(?,?,?)");
+    for (int i = 1; i <= 100; ++i) {
+        if (i % 10) {
+            assert(s.execute(i, "person " + std::to_string(i), i * 1.5));
+        } else {
+            assert(s.execute(i, nullptr, nullptr));
+        }
+    }
+
+    // test integer, floating point and string values
+    assert(conn.createFunction("square", &square, true));
+    assert(conn.createFunction("kg2lb", [](double kg) { return kg * 2.2; }));
+    assert(conn.createFunction("greet", [](const std::string& name) {
+        return "hello, " + name;
+    }));
+    int code = 0;
+    assert(conn.read<int64_t>("SELECT square(id) FROM Person WHERE id = 7",
+                              &code) == 49 && code == Connection::ReadSuccess);
+    assert(conn.read<double>("SELECT kg2lb(weight) FROM Person WHERE id = 2",
+                             &code) == 3.0 * 2.2);
+    assert(conn.readString("SELECT greet(name) FROM Person WHERE id = 3")
+           == "hello, person 3");
+
+    // test text is taken without copy and filter is done by sqlite3
+    assert(conn.createFunction("suffix", [](std::pair<const char*, int> text,
+                                            int                         n) {
+        return (text.first && text.second >= n) ? std::atoi(
+                                    text.first + text.second - n) : -1;
+    }));
+    assert(conn.readInt64("SELECT count(*) FROM Person "
+                          "WHERE suffix(name, 1) = 5") == 10);
+    assert(conn.readInt64("SELECT count(*) FROM Person "
+                          "WHERE suffix(name, 1) = -1") == 10);
+
+    // test NULL values of arguments and result
+    assert(conn.createFunction("half", [](std::pair<double, bool> value) {
+        return std::pair<double, bool>(value.first / 2, value.second);
+    }));
+    assert(conn.read<double>("SELECT half(weight) FROM Person WHERE id = 4",
+                             &code) == 3.0);
+    conn.read<double>("SELECT half(weight) FROM Person WHERE id = 10", &code);
+    assert(code == Connection::NullValue);
+
+    // test blob result
+    assert(conn.createFunction("bytes", [](int count) {
+        return std::vector<unsigned char>(count, 7);
+    }));
+    assert(conn.readInt64("SELECT length(bytes(5))") == 5);
+
+    // test exception is reported as error of statement
+    assert(conn.createFunction("fail", [](int) -> int {
+        throw std::runtime_error("function failed");
+    }));
+    s = conn.prepare("SELECT fail(id) FROM Person");
+    assert(s.isValid() && !s.next());
+    assert(s.lastError() == "function failed");
+
+    // test deterministic function can be used in index, the other one can
+    // be used by view only
+    assert(conn.createFunction("counter", [](int value) {
+        static int calls = 0;
+        return value + ++calls;
+    }));
+    assert(!conn.execute("CREATE INDEX PersonCounter ON Person(counter(id))"));
+    assert(conn.execute("CREATE VIEW CounterView AS "
+                        "SELECT counter(id) FROM Person"));
+    assert(conn.prepare("SELECT * FROM CounterView").isValid());
+
+    // test direct-only function is not called by view (sqlite3 3.30)
+    assert(conn.createFunction("secret", [](int value) { return value; },
+                               false, true));
+    assert(conn.readInt64("SELECT secret(7)") == 7);
+    assert(conn.execute("CREATE VIEW SecretView AS "
+                        "SELECT secret(id) FROM Person"));
+    assert(conn.prepare("SELECT * FROM SecretView").isValid()
+           == (sqlite3_libversion_number() < 3030000));
+    assert(conn.execute("CREATE INDEX PersonSquare ON Person(square(id))"));
+    assert(conn.readInt64("SELECT id FROM Person WHERE square(id) = 81")
+           == 9);
+
+    // test wrong count of arguments is refused by sqlite3
+    assert(!conn.prepare("SELECT square(1, 2)").isValid());
+
+    // test function is replaced (old function object is freed)
+    assert(conn.createFunction("kg2lb", [](int64_t kg) { return kg * 2; }));
+    assert(conn.readInt64("SELECT kg2lb(3)") == 6);
+
+    return std::string("OK");
+}
+
+std::string testAggregateFunction() {
+    Connection conn(Connection::OpenMode::Temporary);
+
+    // test aggregate is not registered on closed connection
+    assert(!conn.createAggregate<Median>("median"));
+
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Sale (id INTEGER NOT NULL PRIMARY KEY, "
+                        "shop INT, item TEXT, price DOUBLE, quantity INT)"));
+    Statement s = conn.prepare("INSERT INTO Sale(shop,item,price,quantity) "
+                               "VALUES(?,?,?,?)");
+    for (int i = 0; i < 300; ++i) {
+        if (i % 50) {
+            assert(s.execute(i % 3, "item " + std::to_string(i % 7), i * 1.0,
+                             i % 5));
+        } else {
+            assert(s.execute(i % 3, "item 0", nullptr, 1));
+        }
+    }
+
+    assert(conn.createAggregate<Median>("median"));
+    assert(conn.createAggregate<TopText>("top_text"));
+    assert(conn.createAggregate<Counter>("counter"));
+
+    // test median of groups is computed by sqlite3 in one pass
+    s = conn.prepare("SELECT shop, median(price) FROM Sale GROUP BY shop "
+                     "ORDER BY shop");
+    std::vector<double> prices[3];
+    Statement all = conn.prepare("SELECT shop, price FROM Sale "
+                                 "WHERE price IS NOT NULL");
+    while (all.next()) {
+        prices[all.getInt(0)].push_back(all.getDouble(1));
+    }
+    for (int shop = 0; shop < 3; ++shop) {
+        std::vector<double>& values = prices[shop];
+        std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                         values.end());
+        assert(s.next() && s.getInt(0) == shop);
+        assert(s.getDouble(1) == values[values.size() / 2]);
+    }
+    assert(!s.next());
+
+    // test empty group and group of NULL values
+    int code = 0;
+    conn.read<double>("SELECT median(price) FROM Sale WHERE id < 0", &code);
+    assert(code == Connection::NullValue);
+    conn.read<double>("SELECT median(price) FROM Sale WHERE price IS NULL",
+                      &code);
+    assert(code == Connection::NullValue);
+
+    // test aggregate with a few arguments and text result
+    assert(conn.readString("SELECT top_text(item, quantity) FROM Sale "
+                           "WHERE shop = 1") == "item 0");
+
+    // test exception is reported as error of statement
+    s = conn.prepare("SELECT top_text(item, -1) FROM Sale");
+    assert(s.isValid() && !s.next());
+    assert(s.lastError() == "negative weight");
+
+    // test states are destroyed (after failure too)
+    assert(conn.readInt64("SELECT counter() FROM Sale WHERE id < 0") == 0);
+    assert(conn.readInt64("SELECT count(*) FROM (SELECT counter() "
+                          "FROM Sale GROUP BY item)") == 7);
+    s = conn.prepare("SELECT counter(), top_text(item, quantity - 5) "
+                     "FROM Sale GROUP BY shop");
+    assert(s.isValid() && !s.next());
+    s.clear();
+    assert(Counter::alive == 0);
+
+    // test wrong count of arguments is refused by sqlite3
+    assert(!conn.prepare("SELECT median(price, 1) FROM Sale").isValid());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test scalar SQL functions: "
+              << testScalarFunction() << std::endl;
+    std::cout << "Test aggregate SQL functions: "
+              << testAggregateFunction() << std::endl;
+
+    return 0;
+}
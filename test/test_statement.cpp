@@ -1,10 +1,14 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "../include/connection.h"
+#include "../include/sqlite3.h"
 #include "../include/statement.h"
 
 
@@ -247,6 +251,311 @@ std::string testUtf16() {
     return std::string("OK");
 }
 
+std::string testVariadicBind() {
+    static const std::string fileName("test_bind.db");
+    static const unsigned char blob[3] = { 1, 2, 3 };
+
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, age INT, weight DOUBLE, "
+                        "present BOOLEAN, binData BLOB)"));
+
+    Statement s = conn.prepare("INSERT INTO Person(id,name,age,weight,"
+                               "present,binData) VALUES(?,?,?,?,?,?)");
+    assert(s.isValid());
+
+    // test execute with values of different types
+    std::string name("mike");
+    assert(s.execute(int64_t(1), name, 30, 80.5, true,
+                     std::pair<const unsigned char*, int>(blob, 3)));
+    assert(s.execute(2, "kate", std::pair<int, bool>(25, true),
+                     std::pair<double, bool>(0.0, false), false, nullptr));
+    assert(s.execute(3u, std::u16string(u"john"), nullptr, 70.0f,
+                     std::pair<bool, bool>(true, true),
+                     std::vector<unsigned char>(blob, blob + 2)));
+
+    // test bind copies of temporary values and execute later
+    assert(s.bindAllCopy(4, std::string("tom"), 40, 90.0, true, nullptr));
+    assert(s.execute());
+
+    // test failed execution (duplicate primary key)
+    assert(!s.execute(4, "tom", 40, 90.0, true, nullptr));
+    s.clear();
+
+    // test read inserted values
+    s = conn.prepare("SELECT name, age, weight, present, binData "
+                     "FROM Person ORDER BY id ASC");
+    assert(s.next());
+    assert(s.get<std::string>(0) == name && s.get<int>(1) == 30);
+    assert(s.get<double>(2) == 80.5 && s.get<bool>(3));
+    std::pair<const unsigned char*, int> data
+            = s.get<std::pair<const unsigned char*, int>>(4);
+    assert(data.second == 3 && !memcmp(data.first, blob, 3));
+
+    assert(s.next());
+    assert(s.get<std::string>(0) == "kate" && s.get<int64_t>(1) == 25);
+    assert(!(s.get<std::pair<double, bool>>(2).second));
+    assert(!s.get<bool>(3) && s.isNull(4));
+
+    assert(s.next());
+    assert(s.get<std::u16string>(0) == u"john");
+    assert(!(s.get<std::pair<int, bool>>(1).second));
+    assert(s.get<float>(2) == 70.0f);
+    assert(s.get<std::vector<unsigned char>>(4).size() == 2);
+
+    assert(s.next());
+    assert(s.get<std::string>(0) == "tom");
+    assert(!s.next());
+    s.clear();
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+struct Person {
+    int64_t id;
+    std::string name;
+    std::pair<double, bool> weight;
+};
+
+template <>
+struct RowMapper<Person>
+{
+    using Columns = std::tuple<int64_t, std::string, std::pair<double, bool>>;
+
+    static Person make(int64_t&& id, std::string&& name,
+                       std::pair<double, bool>&& weight)
+    {
+        return Person { id, std::move(name), weight };
+    }
+};
+
+std::string testRowIteration() {
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, weight DOUBLE)"));
+
+    Statement s = conn.prepare("INSERT INTO Person(id,name,weight) "
+                               "VALUES(?,?,?)");
+    assert(s.execute(1, "mike", 80.5));
+    assert(s.execute(2, "kate", nullptr));
+    assert(s.execute(3, "john", 70.1));
+
+    // test decode rows into tuples
+    s = conn.prepare("SELECT id, name, weight FROM Person ORDER BY id");
+    int count = 0;
+    for (const std::tuple<int64_t, std::string, std::pair<double, bool>>& row
+         : s.rows<int64_t, std::string, std::pair<double, bool>>()) {
+        ++count;
+        assert(std::get<0>(row) == count);
+        assert(std::get<2>(row).second == (count != 2));
+    }
+    assert(count == 3);
+
+    // test decode rows into user structures (after statement reset)
+    s.rewind();
+    std::vector<Person> persons;
+    for (const Person& person : s.rowsAs<Person>()) {
+        persons.push_back(person);
+    }
+    assert(persons.size() == 3);
+    assert(persons[0].name == "mike" && persons[0].weight.first == 80.5);
+    assert(persons[1].name == "kate" && !persons[1].weight.second);
+    assert(persons[2].id == 3);
+
+    // test empty result
+    s = conn.prepare("SELECT id FROM Person WHERE id > 5");
+    RowRange<std::tuple<int>> range = s.rows<int>();
+    assert(range.begin() == range.end());
+
+    return std::string("OK");
+}
+
+
+std::string testColumnViews() {
+    static const unsigned char blob[3] = { 1, 0, 2 };
+
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, binData BLOB)"));
+
+    Statement s = conn.prepare("INSERT INTO Person(id,name,binData) "
+                               "VALUES(?,?,?)");
+    assert(s.execute(1, "mike",
+                     std::pair<const unsigned char*, int>(blob, 3)));
+    assert(s.execute(2, nullptr, nullptr));
+
+    // test views of the current row
+    s = conn.prepare("SELECT name, binData FROM Person ORDER BY id");
+    assert(s.next());
+    TextView name = s.getTextView(0);
+    BlobView data = s.getBlobView(1);
+    assert(name.isValid() && !name.isNull());
+    assert(name == std::string("mike") && name.size() == 4);
+    assert(name.toString() == "mike");
+    assert(data.size() == 3 && data[1] == 0 && data[2] == 2);
+    assert(data.toVector() == std::vector<unsigned char>(blob, blob + 3));
+
+    // test views of null values (views are checked in debug mode only)
+    assert(s.next());
+#ifdef DEBUG
+    assert(!name.isValid() && !data.isValid());
+#endif
+    name = s.getTextView(0);
+    data = s.getBlobView(1);
+    assert(name.isValid() && name.isNull() && name.empty());
+    assert(data.isNull() && data.toVector().empty());
+
+    assert(TextView().isValid() && TextView().isNull());
+
+#ifdef DEBUG
+    // test views become invalid on reset and on finalize
+    s.rewind();
+    assert(!name.isValid());
+    assert(s.next());
+    name = s.getTextView(0);
+    s.clear();
+    assert(!name.isValid());
+
+    // test views become invalid, when statement is moved or destroyed
+    s = conn.prepare("SELECT name FROM Person WHERE id = 1");
+    assert(s.next());
+    name = s.getTextView(0);
+    Statement moved(std::move(s));
+    assert(!name.isValid());
+    {
+        Statement local = conn.prepare("SELECT name FROM Person");
+        assert(local.next());
+        name = local.getTextView(0);
+        assert(name.isValid());
+    }
+    assert(!name.isValid());
+#endif
+
+    // test UTF-16 view
+    s = conn.prepare("SELECT name FROM Person WHERE id = 1");
+    assert(s.next());
+    assert(s.getText16View(0) == std::u16string(u"mike"));
+
+    return std::string("OK");
+}
+
+std::string testFetchBatch() {
+    Connection conn(Connection::OpenMode::Temporary);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT, weight DOUBLE, "
+                        "binData BLOB)"));
+
+    Statement s = conn.prepare("INSERT INTO Person(id,name,weight,binData) "
+                               "VALUES(?,?,?,?)");
+    for (int i = 1; i <= 100; ++i) {
+        if (i % 10) {
+            assert(s.execute(i, std::to_string(i), i * 0.5,
+                             std::vector<unsigned char>(i % 3, i)));
+        } else {
+            assert(s.execute(i, nullptr, nullptr, nullptr));
+        }
+    }
+
+    // test fetch rows by batches
+    s = conn.prepare("SELECT id, name, weight, binData FROM Person "
+                     "ORDER BY id");
+    ColumnBatch batch;
+    assert(s.fetchBatch(batch, 64) == 64);
+    assert(batch.columnCount() == 4 && batch.rowCount() == 64);
+    assert(batch.type(0) == ColumnBatch::Type::Integer);
+    assert(batch.type(1) == ColumnBatch::Type::Text);
+    assert(batch.type(2) == ColumnBatch::Type::Float);
+    assert(batch.type(3) == ColumnBatch::Type::Blob);
+
+    int64_t sum = 0;
+    for (int i = 0; i < batch.rowCount(); ++i) {
+        sum += batch.integers(0)[i];
+    }
+    assert(sum == 64 * 65 / 2);
+    assert(batch.floats(2)[4] == 2.5);
+    assert(std::string(batch.text(1, 10).first, batch.text(1, 10).second)
+           == "11");
+    assert(batch.blob(3, 1).second == 2 && batch.blob(3, 1).first[0] == 2);
+
+    // test null values
+    assert(batch.isNull(1, 9) && batch.isNull(2, 9) && batch.isNull(3, 9));
+    assert(!batch.isNull(0, 9) && !batch.isNull(1, 8));
+    assert(batch.nullBitmap(1)[0] == ((uint64_t(1) << 9) | (uint64_t(1) << 19)
+                                      | (uint64_t(1) << 29)
+                                      | (uint64_t(1) << 39)
+                                      | (uint64_t(1) << 49)
+                                      | (uint64_t(1) << 59)));
+    assert(batch.text(1, 9).first == nullptr && batch.text(1, 9).second == 0);
+    assert(batch.floats(2)[9] == 0.0);
+
+    // test the rest of rows and the end of result
+    assert(s.fetchBatch(batch, 64) == 36);
+    assert(batch.integers(0)[0] == 65 && batch.integers(0)[35] == 100);
+    assert(batch.offsets(1)[1] == 2);
+    assert(s.fetchBatch(batch, 64) == 0);
+
+    // test batch returned by value
+    s.rewind();
+    assert(s.fetchBatch(10).rowCount() == 10);
+
+    // test end of result is kept by statement, when batch is reused
+    Statement other = conn.prepare("SELECT id FROM Person WHERE id <= 5");
+    assert(other.fetchBatch(batch, 10) == 5);
+    assert(s.fetchBatch(batch, 100) == 90);
+    assert(other.fetchBatch(batch, 10) == 0);
+    assert(other.fetchBatch(batch, 10) == 5);
+    assert(s.fetchBatch(batch, 100) == 0);
+    assert(s.fetchBatch(batch, 0) == -1 && batch.rowCount() == 0);
+    assert(s.fetchBatch(batch, -1) == -1);
+
+    // test types are found again, when batch is used for another query
+    // with the same count of columns
+    Statement ids = conn.prepare("SELECT id FROM Person WHERE id <= 5");
+    Statement names = conn.prepare("SELECT name FROM Person WHERE id = 1");
+    assert(ids.fetchBatch(batch, 10) == 5);
+    assert(batch.type(0) == ColumnBatch::Type::Integer);
+    assert(names.fetchBatch(batch, 10) == 1);
+    assert(batch.type(0) == ColumnBatch::Type::Text);
+    assert(std::string(batch.text(0, 0).first, batch.text(0, 0).second)
+           == "1");
+
+    // test column is promoted for value of other type
+    Statement mixed = conn.prepare("SELECT 1, 1, 1, 'a' UNION ALL "
+                                   "SELECT 2.5, 'text', NULL, x'0102' "
+                                   "UNION ALL SELECT 3, 2.0, 2, 'b'");
+    assert(mixed.fetchBatch(batch, 10) == 3);
+    assert(batch.type(0) == ColumnBatch::Type::Float);
+    assert(batch.floats(0)[0] == 1.0 && batch.floats(0)[1] == 2.5
+           && batch.floats(0)[2] == 3.0);
+    assert(batch.type(1) == ColumnBatch::Type::Text);
+    assert(std::string(batch.data(1), batch.offsets(1)[3]) == "1text2.0");
+    assert(batch.type(2) == ColumnBatch::Type::Integer);
+    assert(batch.isNull(2, 1) && batch.integers(2)[2] == 2);
+    assert(batch.type(3) == ColumnBatch::Type::Blob);
+    assert(batch.blob(3, 1).second == 2 && batch.blob(3, 1).first[1] == 2);
+    assert(std::string(batch.text(3, 2).first, batch.text(3, 2).second)
+           == "b");
+
+    // test error in the middle of result is not reported as its end
+    assert(conn.createFunction("checked", [] (int64_t id) {
+        if (id > 50) {
+            throw std::runtime_error("wrong id");
+        }
+        return id;
+    }));
+    s = conn.prepare("SELECT checked(id) FROM Person ORDER BY id");
+    assert(s.fetchBatch(batch, 64) == -1);
+    assert(s.lastErrorCode() == SQLITE_ERROR);
+
+    return std::string("OK");
+}
 
 int main() {
 
@@ -254,6 +563,14 @@ int main() {
               << testUtf8() << std::endl;
     std::cout << "Test statement on UTF-16 encoded database: "
               << testUtf16() << std::endl;
+    std::cout << "Test variadic bind and typed read: "
+              << testVariadicBind() << std::endl;
+    std::cout << "Test typed row iteration: "
+              << testRowIteration() << std::endl;
+    std::cout << "Test zero-copy column views: "
+              << testColumnViews() << std::endl;
+    std::cout << "Test columnar batch fetch: "
+              << testFetchBatch() << std::endl;
 
     return 0;
 }
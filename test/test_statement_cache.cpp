@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "../include/connection.h"
+#include "../include/statement.h"
+#include "../include/statement_cache.h"
+
+
+static const std::string fileName("test_stmt_cache.db");
+static const std::string insertQuery("INSERT INTO Person (id, name) "
+                                     "VALUES (?, ?)");
+static const std::string selectQuery("SELECT name FROM Person WHERE id = ?");
+
+
+std::string testCacheDisabled() {
+    Connection conn(fileName);
+    assert(conn.open());
+    assert(conn.statementCacheCapacity() == 0);
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT NOT NULL)"));
+
+    // test statements are prepared every time, when cache is off
+    for (int i = 1; i <= 3; ++i) {
+        CachedStatement s = conn.prepareCached(insertQuery);
+        assert(s.isValid());
+        assert(s->bindInt64(1, i));
+        assert(s->bindCStr(2, "mike"));
+        assert(s->execute());
+    }
+
+    StatementCache::Stats stats = conn.statementCacheStats();
+    assert(stats.hits == 0 && stats.misses == 3 && stats.size == 0);
+
+    // test invalid query
+    CachedStatement s = conn.prepareCached("SELECT ids FROM Person");
+    assert(!s.isValid());
+    assert(conn.lastResultCode() != 0);
+
+    conn.close();
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+std::string testCacheHitsAndEviction() {
+    Connection conn(fileName);
+    conn.setStatementCacheCapacity(2);
+    assert(conn.open());
+    assert(conn.execute("CREATE TABLE Person (id INTEGER NOT NULL "
+                        "PRIMARY KEY, name TEXT NOT NULL)"));
+
+    // test repeated query reuses cached statement
+    for (int i = 1; i <= 3; ++i) {
+        CachedStatement s = conn.prepareCached(insertQuery);
+        assert(s.isValid() && s->type() == Statement::NonSelect);
+        assert(s->bindInt64(1, i));
+        assert(s->bindCStr(2, "kate"));
+        assert(s->execute());
+    }
+
+    StatementCache::Stats stats = conn.statementCacheStats();
+    assert(stats.hits == 2 && stats.misses == 1);
+    assert(stats.size == 1 && stats.capacity == 2);
+
+    // test returned statement is reset and its bindings are cleared
+    {
+        CachedStatement s = conn.prepareCached(selectQuery);
+        assert(s->bindInt64(1, 2));
+        assert(s->next());
+        assert(s->getString(0) == "kate");
+    }
+    {
+        CachedStatement s = conn.prepareCached(selectQuery);
+        assert(!s->next());
+    }
+
+    // test the same query leased twice at once
+    {
+        CachedStatement first = conn.prepareCached(selectQuery);
+        CachedStatement second = conn.prepareCached(selectQuery);
+        assert(first.isValid() && second.isValid());
+        assert(&first.statement() != &second.statement());
+    }
+    assert(conn.statementCacheStats().size == 2);
+
+    // test least recently used statement is evicted
+    conn.resetStatementCacheStats();
+    {
+        CachedStatement s = conn.prepareCached("SELECT count(*) FROM Person");
+        assert(s->next() && s->getInt64(0) == 3);
+    }
+    stats = conn.statementCacheStats();
+    assert(stats.misses == 1 && stats.evictions == 1 && stats.size == 2);
+    {
+        CachedStatement s = conn.prepareCached(selectQuery);
+    }
+    assert(conn.statementCacheStats().hits == 1);
+
+    // test shrink cache
+    conn.setStatementCacheCapacity(0);
+    stats = conn.statementCacheStats();
+    assert(stats.size == 0 && stats.evictions == 3);
+
+    // test lease outlives connection
+    conn.setStatementCacheCapacity(4);
+    CachedStatement lease = conn.prepareCached(selectQuery);
+    conn.close();
+    assert(lease.isValid());
+    lease.release();
+    assert(!lease.isValid());
+
+    std::remove(fileName.c_str());
+
+    return std::string("OK");
+}
+
+int main() {
+
+    std::cout << "Test cached statements with disabled cache: "
+              << testCacheDisabled() << std::endl;
+    std::cout << "Test statement cache hits and eviction: "
+              << testCacheHitsAndEviction() << std::endl;
+
+    return 0;
+}
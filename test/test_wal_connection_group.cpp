@@ -0,0 +1,133 @@
+#include <cassert>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/connection.h"
+#include "../include/connection_config.h"
+#include "../include/connection_creator.h"
+#include "../include/create_conn_exception.h"
+#include "../include/wal_connection_group.h"
+
+
+static const std::string script("CREATE TABLE Person (id INTEGER NOT NULL "
+                                "PRIMARY KEY, name TEXT NOT NULL);");
+static const std::string fileName("test_wal.db");
+
+
+void removeFiles() {
+    std::remove(fileName.c_str());
+    std::remove((fileName + "-wal").c_str());
+    std::remove((fileName + "-shm").c_str());
+}
+
+std::string testRouting() {
+    ConnectionConfig config;
+    config.setDatabaseName(fileName);
+    config.setCreateSchemaScript(script);
+
+    ConnectionCreator creator;
+    assert(creator.addConfig(config, "default"));
+
+    // test not existing and not suitable configs
+    try {
+        creator.newWalGroup("other", 2);
+        assert(false);
+    } catch (CreateConnException&) {
+    }
+    config.setOpenMode(Connection::OpenMode::InMemory);
+    assert(creator.addConfig(config, "memory"));
+    try {
+        creator.newWalGroup("memory", 2);
+        assert(false);
+    } catch (CreateConnException&) {
+    }
+
+    // test group opens writer and read-only connections in WAL mode
+    std::shared_ptr<WalConnectionGroup> group
+            = creator.newWalGroup("default", 2);
+    assert(group->readerStats().idle == 2);
+    {
+        PooledConnection reader = group->acquireReader();
+        assert(reader->readString("SELECT journal_mode "
+                                 "FROM pragma_journal_mode") == "wal");
+        assert(!reader->execute("INSERT INTO Person (id, name) "
+                                "VALUES (100, 'mike')"));
+    }
+
+    // test writes are routed to the writer
+    std::vector<std::future<bool>> written;
+    for (int i = 1; i <= 10; ++i) {
+        written.push_back(group->execute("INSERT INTO Person (id, name) "
+                                         "VALUES (?, ?)", i, "mike"));
+    }
+    for (std::future<bool>& result : written) {
+        assert(result.get());
+    }
+
+    // test write does not wait for readers, when all of them are acquired
+    {
+        PooledConnection first = group->acquireReader();
+        PooledConnection second = group->acquireReader();
+        assert(group->execute("UPDATE Person SET name = ? WHERE id = ?",
+                              "kate", 1).get());
+    }
+
+    // test reads are done by readers (and refused by execute)
+    int64_t sum = 0;
+    assert(group->readRows("SELECT id FROM Person WHERE id > ?",
+                           [&sum] (const Statement& row) {
+        sum += row.getInt64(0);
+    }, 5));
+    assert(sum == 6 + 7 + 8 + 9 + 10);
+    assert(!group->execute("SELECT id FROM Person").valid());
+    assert(group->isReadQuery("SELECT id FROM Person"));
+    assert(!group->isReadQuery("DELETE FROM Person"));
+    assert(group->read<int>("SELECT count(*) FROM Person", nullptr) == 10);
+    assert(group->readerStats().acquired > 0);
+
+    // test statement types
+    PooledConnection reader = group->acquireReader();
+    assert(WalConnectionGroup::isRead(reader->prepare("SELECT 1")));
+    assert(!WalConnectionGroup::isRead(reader->prepare("DELETE FROM Person")));
+    assert(!WalConnectionGroup::isRead(reader->prepare("BEGIN")));
+    reader.release();
+
+    // test reader is not blocked by open write transaction
+    std::promise<void> gate;
+    std::shared_future<void> opened(gate.get_future());
+    std::promise<void> started;
+    std::future<bool> transaction = group->submitWrite(
+                [opened, &started] (Connection& connection) -> bool {
+        const bool result = connection.execute("BEGIN IMMEDIATE")
+                && connection.execute("DELETE FROM Person");
+        started.set_value();
+        opened.wait();
+        return result && connection.commit();
+    });
+    started.get_future().wait();
+    int code;
+    assert(group->read<int>("SELECT count(*) FROM Person", &code) == 10);
+    assert(code == Connection::ReadSuccess);
+    gate.set_value();
+    assert(transaction.get());
+    assert(group->read<int>("SELECT count(*) FROM Person", nullptr) == 0);
+
+    group.reset();
+    removeFiles();
+
+    return std::string("OK");
+}
+
+int main() {
+
+    removeFiles();
+
+    std::cout << "Test WAL group routes reads and writes: "
+              << testRouting() << std::endl;
+
+    return 0;
+}